@@ -0,0 +1,268 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "GpxScanner.h"
+#include "GpxParser.h"
+#include "Track.h"
+
+// Qt includes
+#include <QTest>
+#include <QBuffer>
+
+// The number of track points in the file parsed by the benchmarks
+static const int s_benchmarkPoints = 200000;
+
+static QByteArray gpxFile(const QByteArray &tracks,
+                          const QByteArray &declaration = QByteArrayLiteral(
+                              "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"))
+{
+    return declaration
+           + QByteArrayLiteral("<gpx version=\"1.1\" creator=\"KGeoTag test\" "
+                               "xmlns=\"http://www.topografix.com/GPX/1/1\">\n")
+           + tracks
+           + QByteArrayLiteral("</gpx>\n");
+}
+
+static QByteArray trackPoint(double lat, double lon, double ele, const QByteArray &time)
+{
+    return QByteArrayLiteral("<trkpt lat=\"") + QByteArray::number(lat, 'f', 7)
+           + QByteArrayLiteral("\" lon=\"") + QByteArray::number(lon, 'f', 7)
+           + QByteArrayLiteral("\"><ele>") + QByteArray::number(ele, 'f', 1)
+           + QByteArrayLiteral("</ele><time>") + time
+           + QByteArrayLiteral("</time></trkpt>\n");
+}
+
+static QByteArray toUtf16(const QByteArray &data)
+{
+    // Little endian, with a byte order mark
+    QByteArray utf16 = QByteArrayLiteral("\xFF\xFE");
+    for (const char character : data) {
+        utf16.append(character);
+        utf16.append('\0');
+    }
+    return utf16;
+}
+
+static bool scan(const QByteArray &data, Track *track, GpxEngine::LoadInfo *info)
+{
+    *info = { GpxEngine::Okay };
+    return GpxScanner::scan(data.constData(), data.size(), track, info);
+}
+
+static GpxEngine::LoadInfo parse(const QByteArray &data, Track *track)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    return GpxParser::parse(&buffer, track);
+}
+
+class GpxScannerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void sameAsParser_data();
+    void sameAsParser();
+    void fallback_data();
+    void fallback();
+    void benchmarkScanner();
+    void benchmarkParser();
+
+private: // Functions
+    void compareTracks(const Track &scanned, const Track &parsed);
+
+private: // Variables
+    QByteArray m_benchmarkData;
+
+};
+
+void GpxScannerTest::initTestCase()
+{
+    QByteArray points;
+    for (int i = 0; i < s_benchmarkPoints; i++) {
+        const auto time = QByteArrayLiteral("2021-03-14T")
+                          + QByteArray::number(10 + i / 3600 % 10) + ':'
+                          + QByteArray::number(10 + i / 60 % 50) + ':'
+                          + QByteArray::number(10 + i % 50) + 'Z';
+        points.append(trackPoint(48.0 + i * 0.00001, 11.0 + i * 0.00001, 500.0 + i % 100, time));
+    }
+    m_benchmarkData = gpxFile(QByteArrayLiteral("<trk><name>Benchmark</name><trkseg>\n")
+                              + points
+                              + QByteArrayLiteral("</trkseg></trk>\n"));
+}
+
+void GpxScannerTest::compareTracks(const Track &scanned, const Track &parsed)
+{
+    QCOMPARE(scanned.count(), parsed.count());
+    QCOMPARE(scanned.segmentCount(), parsed.segmentCount());
+    for (int segment = 0; segment < scanned.segmentCount(); segment++) {
+        QCOMPARE(scanned.segmentStart(segment), parsed.segmentStart(segment));
+    }
+    for (int point = 0; point < scanned.count(); point++) {
+        QCOMPARE(scanned.time(point), parsed.time(point));
+        QCOMPARE(scanned.coordinates(point), parsed.coordinates(point));
+    }
+}
+
+void GpxScannerTest::sameAsParser_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("simple") << gpxFile(
+        "<trk><trkseg>\n"
+        + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + trackPoint(48.2, 11.6, 521.5, "2021-03-14T15:09:27.5Z")
+        + trackPoint(48.3, 11.7, 522.0, "2021-03-14T16:09:28+01:00")
+        + "</trkseg></trk>\n");
+
+    QTest::newRow("several tracks and segments") << gpxFile(
+        "<trk><name>One</name><trkseg>\n"
+        + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + "</trkseg><trkseg>\n"
+        + trackPoint(48.2, 11.6, 521.0, "2021-03-14T15:10:26Z")
+        + "</trkseg></trk>\n<trk><trkseg>\n"
+        + trackPoint(-33.9, 151.2, 10.0, "2021-03-15T01:00:00Z")
+        + "</trkseg></trk>\n");
+
+    QTest::newRow("no declaration") << gpxFile(
+        "<trk><trkseg>\n" + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + "</trkseg></trk>\n", QByteArray());
+
+    QTest::newRow("missing and empty values") << gpxFile(
+        "<trk><trkseg>\n"
+        "<trkpt lon='11.5' lat='48.1'/>\n"
+        "<trkpt lat=\"48.2\" lon=\"11.6\"><ele/><time></time></trkpt>\n"
+        "<trkpt lat=\"48.3\" lon=\"11.7\"><time>no time</time></trkpt>\n"
+        "</trkseg></trk>\n");
+
+    QTest::newRow("prefixes, comments and extensions") << QByteArrayLiteral(
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<!-- A comment before the gpx element -->\n"
+        "<g:gpx xmlns:g=\"http://www.topografix.com/GPX/1/1\">\n"
+        "<g:metadata><g:time>2020-01-01T00:00:00Z</g:time></g:metadata>\n"
+        "<g:wpt lat=\"1.0\" lon=\"2.0\"><g:ele>3.0</g:ele></g:wpt>\n"
+        "<g:trk><g:trkseg>\n"
+        "<g:trkpt lat=\"48.1\" lon=\"11.5\"><g:ele>520.0</g:ele>"
+        "<g:time>2021-03-14T15:09:26Z</g:time>"
+        "<g:extensions><speed>1.5</speed></g:extensions></g:trkpt>\n"
+        "<!-- A comment inside the track -->\n"
+        "</g:trkseg></g:trk>\n"
+        "</g:gpx>\n"
+        "<!-- A comment after the gpx element -->\n");
+}
+
+void GpxScannerTest::sameAsParser()
+{
+    QFETCH(QByteArray, data);
+
+    Track scanned;
+    GpxEngine::LoadInfo scannedInfo;
+    QVERIFY(scan(data, &scanned, &scannedInfo));
+
+    Track parsed;
+    const auto parsedInfo = parse(data, &parsed);
+    QCOMPARE(parsedInfo.result, GpxEngine::Okay);
+
+    QCOMPARE(scannedInfo.tracks, parsedInfo.tracks);
+    QCOMPARE(scannedInfo.segments, parsedInfo.segments);
+    QCOMPARE(scannedInfo.points, parsedInfo.points);
+    compareTracks(scanned, parsed);
+}
+
+void GpxScannerTest::fallback_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("result");
+    QTest::addColumn<int>("points");
+
+    const auto trackSegment = [](const QByteArray &points)
+    {
+        return gpxFile("<trk><trkseg>\n" + points + "</trkseg></trk>\n");
+    };
+
+    QTest::newRow("CDATA") << trackSegment(
+        "<trkpt lat=\"48.1\" lon=\"11.5\">"
+        "<time><![CDATA[2021-03-14T15:09:26Z]]></time></trkpt>\n")
+        << int(GpxEngine::Okay) << 1;
+
+    QTest::newRow("entity in an attribute") << trackSegment(
+        "<trkpt lat=\"&#52;8.1\" lon=\"11.5\"><ele>520.0</ele></trkpt>\n")
+        << int(GpxEngine::Okay) << 1;
+
+    QTest::newRow("entity in a value") << trackSegment(
+        "<trkpt lat=\"48.1\" lon=\"11.5\"><ele>&#53;20.0</ele></trkpt>\n")
+        << int(GpxEngine::Okay) << 1;
+
+    QTest::newRow("DOCTYPE") << gpxFile(
+        "<trk><trkseg>\n" + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + "</trkseg></trk>\n",
+        QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!DOCTYPE gpx>\n"))
+        << int(GpxEngine::Okay) << 1;
+
+    QTest::newRow("mismatched end tag") << trackSegment(
+        "<trkpt lat=\"48.1\" lon=\"11.5\"><ele>520.0</time></trkpt>\n")
+        << int(GpxEngine::XmlError) << 1;
+
+    QTest::newRow("unclosed gpx element") << QByteArrayLiteral(
+        "<gpx><trk><trkseg><trkpt lat=\"48.1\" lon=\"11.5\"></trkpt></trkseg></trk>\n")
+        << int(GpxEngine::XmlError) << 1;
+
+    QTest::newRow("UTF-16") << toUtf16(gpxFile(
+        "<trk><trkseg>\n" + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + "</trkseg></trk>\n",
+        QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"UTF-16\"?>\n")))
+        << int(GpxEngine::Okay) << 1;
+
+    QTest::newRow("other encoding") << gpxFile(
+        "<trk><trkseg>\n" + trackPoint(48.1, 11.5, 520.0, "2021-03-14T15:09:26Z")
+        + "</trkseg></trk>\n",
+        QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n"))
+        << int(GpxEngine::Okay) << 1;
+}
+
+void GpxScannerTest::fallback()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, result);
+    QFETCH(int, points);
+
+    Track scanned;
+    GpxEngine::LoadInfo scannedInfo;
+    QVERIFY(! scan(data, &scanned, &scannedInfo));
+
+    Track parsed;
+    const auto parsedInfo = parse(data, &parsed);
+    QCOMPARE(int(parsedInfo.result), result);
+    if (result == GpxEngine::Okay) {
+        QCOMPARE(parsedInfo.points, points);
+        QCOMPARE(parsed.count(), points);
+    }
+}
+
+void GpxScannerTest::benchmarkScanner()
+{
+    QBENCHMARK {
+        Track track;
+        GpxEngine::LoadInfo info;
+        QVERIFY(scan(m_benchmarkData, &track, &info));
+        QCOMPARE(track.count(), s_benchmarkPoints);
+    }
+}
+
+void GpxScannerTest::benchmarkParser()
+{
+    QBENCHMARK {
+        Track track;
+        const auto info = parse(m_benchmarkData, &track);
+        QCOMPARE(info.result, GpxEngine::Okay);
+        QCOMPARE(track.count(), s_benchmarkPoints);
+    }
+}
+
+QTEST_GUILESS_MAIN(GpxScannerTest)
+
+#include "GpxScannerTest.moc"
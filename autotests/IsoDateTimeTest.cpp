@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "IsoDateTime.h"
+
+// Qt includes
+#include <QTest>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QList>
+
+// The number of timestamps parsed by the benchmarks
+static const int s_benchmarkCount = 1000000;
+
+// What IsoDateTime's fallback does: Parse the text using Qt and drop the milliseconds
+static bool qtSecsSinceEpoch(const QString &text, qint64 *seconds)
+{
+    const auto dateTime = QDateTime::fromString(text, Qt::ISODate);
+    if (! dateTime.isValid()) {
+        return false;
+    }
+
+    const auto milliseconds = dateTime.toMSecsSinceEpoch();
+    *seconds = milliseconds / 1000 - (milliseconds % 1000 < 0 ? 1 : 0);
+    return true;
+}
+
+class IsoDateTimeTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void sameAsQt_data();
+    void sameAsQt();
+    void benchmarkIsoDateTime();
+    void benchmarkQDateTime();
+
+private: // Variables
+    QList<QString> m_timestamps;
+
+};
+
+void IsoDateTimeTest::initTestCase()
+{
+    // Timestamps as written by GPS loggers, one per second
+    const qint64 start = QDateTime(QDate(2021, 3, 14), QTime(15, 9, 26),
+                                   QTimeZone::utc()).toSecsSinceEpoch();
+    m_timestamps.reserve(s_benchmarkCount);
+    for (int i = 0; i < s_benchmarkCount; i++) {
+        m_timestamps.append(QDateTime::fromSecsSinceEpoch(start + i, QTimeZone::utc())
+                                .toString(Qt::ISODate));
+    }
+}
+
+void IsoDateTimeTest::sameAsQt_data()
+{
+    QTest::addColumn<QString>("text");
+
+    // Handled by the fast path
+    QTest::newRow("UTC") << QStringLiteral("2021-03-14T15:09:26Z");
+    QTest::newRow("fractional seconds") << QStringLiteral("2021-03-14T15:09:26.535Z");
+    QTest::newRow("positive offset") << QStringLiteral("2021-03-14T16:09:26+01:00");
+    QTest::newRow("negative offset") << QStringLiteral("2021-03-14T09:39:26-05:30");
+    QTest::newRow("fractional seconds and offset")
+        << QStringLiteral("2021-03-14T16:09:26.5+01:00");
+    QTest::newRow("before 1970") << QStringLiteral("1969-12-31T23:59:59.5Z");
+    QTest::newRow("leap day") << QStringLiteral("2020-02-29T12:00:00Z");
+    QTest::newRow("surrounding whitespace") << QStringLiteral("  2021-03-14T15:09:26Z\n");
+
+    // Left to Qt
+    QTest::newRow("no offset") << QStringLiteral("2021-03-14T15:09:26");
+    QTest::newRow("truncated offset") << QStringLiteral("2021-03-14T16:09:26+01:");
+    QTest::newRow("no leap day") << QStringLiteral("2021-02-29T12:00:00Z");
+    QTest::newRow("invalid month") << QStringLiteral("2021-13-14T15:09:26Z");
+    QTest::newRow("no time") << QStringLiteral("2021-03-14");
+    QTest::newRow("empty") << QString();
+}
+
+void IsoDateTimeTest::sameAsQt()
+{
+    QFETCH(QString, text);
+
+    qint64 expected = 0;
+    const bool expectedValid = qtSecsSinceEpoch(text.trimmed(), &expected);
+
+    qint64 seconds = 0;
+    QCOMPARE(IsoDateTime::toSecsSinceEpoch(text, &seconds), expectedValid);
+    if (expectedValid) {
+        QCOMPARE(seconds, expected);
+    }
+}
+
+void IsoDateTimeTest::benchmarkIsoDateTime()
+{
+    qint64 sum = 0;
+    QBENCHMARK {
+        for (const auto &timestamp : std::as_const(m_timestamps)) {
+            qint64 seconds;
+            if (IsoDateTime::toSecsSinceEpoch(timestamp, &seconds)) {
+                sum += seconds;
+            }
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void IsoDateTimeTest::benchmarkQDateTime()
+{
+    qint64 sum = 0;
+    QBENCHMARK {
+        for (const auto &timestamp : std::as_const(m_timestamps)) {
+            qint64 seconds;
+            if (qtSecsSinceEpoch(timestamp, &seconds)) {
+                sum += seconds;
+            }
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+QTEST_GUILESS_MAIN(IsoDateTimeTest)
+
+#include "IsoDateTimeTest.moc"
@@ -164,6 +164,11 @@ AutomaticMatchingWidget::AutomaticMatchingWidget(Settings *settings, QWidget *pa
     m_excludeManuallyTagged->setCheckable(true);
     m_excludeManuallyTagged->setChecked(m_settings->excludeManuallyTaggedWhenReassigning());
 
+    m_detectTimeZonePerImage = reassignMenu->addAction(
+        i18n("Detect each image's timezone from its location"));
+    m_detectTimeZonePerImage->setCheckable(true);
+    m_detectTimeZonePerImage->setChecked(m_settings->detectTimeZonePerImage());
+
     reassignButton->setMenu(reassignMenu);
     buttonsLayout->addWidget(reassignButton);
 }
@@ -192,6 +197,7 @@ void AutomaticMatchingWidget::saveSettings()
     m_settings->saveMaximumInterpolationDistance(m_enableMaximumInterpolationDistance->isChecked()
         ? m_maximumInterpolationDistance->value() : -1);
     m_settings->saveExcludeManuallyTaggedWhenReassigning(m_excludeManuallyTagged->isChecked());
+    m_settings->saveDetectTimeZonePerImage(m_detectTimeZonePerImage->isChecked());
 
     QMessageBox::information(this, i18n("Save as default"), i18n("Settings saved!"));
 }
@@ -201,6 +207,11 @@ bool AutomaticMatchingWidget::excludeManuallyTagged() const
     return m_excludeManuallyTagged->isChecked();
 }
 
+bool AutomaticMatchingWidget::detectTimeZonePerImage() const
+{
+    return m_detectTimeZonePerImage->isChecked();
+}
+
 int AutomaticMatchingWidget::exactMatchTolerance() const
 {
     return m_exactMatchTolerance->value();
@@ -26,6 +26,7 @@ class AutomaticMatchingWidget : public QWidget
 public:
     explicit AutomaticMatchingWidget(Settings *settings, QWidget *parent = nullptr);
     bool excludeManuallyTagged() const;
+    bool detectTimeZonePerImage() const;
     int exactMatchTolerance() const;
     int maximumInterpolationInterval() const;
     int maximumInterpolationDistance() const;
@@ -48,6 +49,7 @@ private: // Variables
     QSpinBox *m_maximumInterpolationDistance;
 
     QAction *m_excludeManuallyTagged;
+    QAction *m_detectTimeZonePerImage;
 
 };
 
@@ -45,45 +45,12 @@ bool GeoDataModel::contains(const QString &path)
     return m_loadedFiles.contains(canonicalPath(path));
 }
 
-void GeoDataModel::addTrack(const QString &path, const QList<QList<QDateTime>> &times,
-                            const QList<QList<Coordinates>> &segments)
-{
-    Marble::GeoDataLatLonAltBox marbleTrackBox;
-    QList<Marble::GeoDataLineString> marbleTracks;
-
-    QList<QDateTime> dateTimes;
-    QHash<QDateTime, Coordinates> trackPoints;
-
-    for (int i = 0; i < times.count(); i++) {
-        Marble::GeoDataLineString lineString;
-
-        for (int j = 0; j < times.at(i).count(); j++) {
-            const auto &coordinates = segments.at(i).at(j);
-            const Marble::GeoDataCoordinates marbleCoordinates
-                = Marble::GeoDataCoordinates(coordinates.lon(), coordinates.lat(), 0.0,
-                                            Marble::GeoDataCoordinates::Degree);
-            lineString.append(marbleCoordinates);
-
-            const auto &dateTime = times.at(i).at(j);
-            dateTimes.append(dateTime);
-            trackPoints[dateTime] = coordinates;
-        }
-
-        const auto box = lineString.latLonAltBox();
-        if (marbleTrackBox.isEmpty()) {
-            marbleTrackBox = box;
-        } else {
-            marbleTrackBox |= box;
-        }
-        marbleTracks.append(lineString);
-    }
-
-    m_marbleTracks.append(marbleTracks);
-    m_marbleTrackBoxes.append(marbleTrackBox);
-
-    std::sort(dateTimes.begin(), dateTimes.end());
-    m_dateTimes.append(dateTimes);
-    m_trackPoints.append(trackPoints);
+void GeoDataModel::addTrack(const QString &path, const TrackLines &trackLines)
+{
+    const auto &track = trackLines.track();
+    m_trackData.tracks.append(track);
+    m_trackData.trackPointIndex.addTrack(track);
+    m_trackLines.append(trackLines);
 
     m_loadedFiles.append(canonicalPath(path));
     const QFileInfo info(path);
@@ -99,10 +66,15 @@ void GeoDataModel::removeTrack(int row)
     const auto modelIndex = index(row, 0);
     m_loadedFiles.remove(row);
     m_displayFileNames.remove(row);
-    m_marbleTracks.remove(row);
-    m_marbleTrackBoxes.remove(row);
-    m_dateTimes.remove(row);
-    m_trackPoints.remove(row);
+    m_trackData.tracks.remove(row);
+    m_trackLines.remove(row);
+
+    // Rebuild the time index, so that points from the remaining tracks take over
+    m_trackData.trackPointIndex.clear();
+    for (const auto &track : std::as_const(m_trackData.tracks)) {
+        m_trackData.trackPointIndex.addTrack(track);
+    }
+
     Q_EMIT dataChanged(modelIndex, modelIndex, { Qt::DisplayRole });
     endRemoveRows();
 }
@@ -115,10 +87,9 @@ void GeoDataModel::removeAllTracks()
     beginRemoveRows(QModelIndex(), 0, lastRow);
     m_loadedFiles.clear();
     m_displayFileNames.clear();
-    m_marbleTracks.clear();
-    m_marbleTrackBoxes.clear();
-    m_dateTimes.clear();
-    m_trackPoints.clear();
+    m_trackLines.clear();
+    m_trackData.tracks.clear();
+    m_trackData.trackPointIndex.clear();
     Q_EMIT dataChanged(firstModelIndex, lastModelIndex, { Qt::DisplayRole });
     endRemoveRows();
 }
@@ -131,7 +102,7 @@ QString GeoDataModel::canonicalPath(const QString &path) const
 
 Marble::GeoDataLatLonAltBox GeoDataModel::trackBox(const QString &path) const
 {
-    return m_marbleTrackBoxes.at(m_loadedFiles.indexOf(canonicalPath(path)));
+    return m_trackData.tracks.at(m_loadedFiles.indexOf(canonicalPath(path))).box();
 }
 
 Coordinates GeoDataModel::trackBoxCenter(const QString &path) const
@@ -145,22 +116,27 @@ Coordinates GeoDataModel::trackBoxCenter(const QString &path) const
 
 Marble::GeoDataLatLonAltBox GeoDataModel::trackBox(const QModelIndex &index) const
 {
-    return m_marbleTrackBoxes.at(index.row());
+    return m_trackData.tracks.at(index.row()).box();
+}
+
+const QList<TrackLines> &GeoDataModel::trackLines() const
+{
+    return m_trackLines;
 }
 
-const QList<QList<Marble::GeoDataLineString>> &GeoDataModel::marbleTracks() const
+const QList<Track> &GeoDataModel::tracks() const
 {
-    return m_marbleTracks;
+    return m_trackData.tracks;
 }
 
-const QList<QList<QDateTime>> &GeoDataModel::dateTimes() const
+const TrackPointIndex &GeoDataModel::trackPointIndex() const
 {
-    return m_dateTimes;
+    return m_trackData.trackPointIndex;
 }
 
-const QList<QHash<QDateTime, Coordinates>> &GeoDataModel::trackPoints() const
+const GeoDataModel::TrackData &GeoDataModel::trackData() const
 {
-    return m_trackPoints;
+    return m_trackData;
 }
 
 Qt::DropActions GeoDataModel::supportedDropActions() const
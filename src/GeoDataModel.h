@@ -7,9 +7,11 @@
 
 // Local includes
 #include "Coordinates.h"
+#include "Track.h"
+#include "TrackLines.h"
+#include "TrackPointIndex.h"
 
 // Marble includes
-#include <marble/GeoDataLineString.h>
 #include <marble/GeoDataLatLonAltBox.h>
 
 // Qt includes
@@ -22,6 +24,14 @@ class GeoDataModel : public QAbstractListModel
     Q_OBJECT
 
 public:
+    // The data needed to search for matches. It's implicitly shared, so a copy is cheap and can be
+    // used as a read-only snapshot e.g. in another thread.
+    struct TrackData
+    {
+        QList<Track> tracks;
+        TrackPointIndex trackPointIndex;
+    };
+
     explicit GeoDataModel(QObject *parent);
 
     int rowCount(const QModelIndex & = QModelIndex()) const override;
@@ -34,17 +44,17 @@ public:
                       const QModelIndex &) override;
 
     bool contains(const QString &path);
-    void addTrack(const QString &path, const QList<QList<QDateTime>> &times,
-                  const QList<QList<Coordinates>> &segments);
+    void addTrack(const QString &path, const TrackLines &trackLines);
     void removeTrack(int row);
     void removeAllTracks();
     Marble::GeoDataLatLonAltBox trackBox(const QString &path) const;
     Marble::GeoDataLatLonAltBox trackBox(const QModelIndex &index) const;
     Coordinates trackBoxCenter(const QString &path) const;
 
-    const QList<QList<Marble::GeoDataLineString>> &marbleTracks() const;
-    const QList<QList<QDateTime>> &dateTimes() const;
-    const QList<QHash<QDateTime, Coordinates>> &trackPoints() const;
+    const QList<TrackLines> &trackLines() const;
+    const QList<Track> &tracks() const;
+    const TrackPointIndex &trackPointIndex() const;
+    const TrackData &trackData() const;
 
 Q_SIGNALS:
     void requestAddFiles(const QList<QString> &paths);
@@ -56,11 +66,10 @@ private: // Variables
     QList<QString> m_loadedFiles;
     QList<QString> m_displayFileNames;
 
-    QList<QList<Marble::GeoDataLineString>> m_marbleTracks;
-    QList<Marble::GeoDataLatLonAltBox> m_marbleTrackBoxes;
+    TrackData m_trackData;
 
-    QList<QList<QDateTime>> m_dateTimes;
-    QList<QHash<QDateTime, Coordinates>> m_trackPoints;
+    // The lines for drawing the tracks, in the same order as the tracks
+    QList<TrackLines> m_trackLines;
 
 };
 
@@ -6,6 +6,11 @@
 
 #include "GpxEngine.h"
 #include "GeoDataModel.h"
+#include "GpxScanner.h"
+#include "GpxParser.h"
+#include "Track.h"
+#include "TrackLines.h"
+#include "TrackCache.h"
 #include "Logging.h"
 
 #include "debugMode.h"
@@ -17,90 +22,25 @@
 
 #include <QDebug>
 #include <QFile>
-#include <QXmlStreamReader>
-#include <QJsonDocument>
-#include <QStandardPaths>
 #include <QFile>
 #include <QLoggingCategory>
 #include <QTimeZone>
+#include <QThread>
+#include <QtConcurrentMap>
 
 // C++ includes
 #include <cmath>
+#include <algorithm>
+#include <utility>
 
-static const auto s_gpx    = QStringLiteral("gpx");
-static const auto s_trk    = QStringLiteral("trk");
-static const auto s_trkpt  = QStringLiteral("trkpt");
-static const auto s_lon    = QStringLiteral("lon");
-static const auto s_lat    = QStringLiteral("lat");
-static const auto s_ele    = QStringLiteral("ele");
-static const auto s_time   = QStringLiteral("time");
-static const auto s_trkseg = QStringLiteral("trkseg");
+// Don't split the images to match into smaller parts than this when matching concurrently
+static const int s_minimumMatchChunkSize = 100;
 
-GpxEngine::GpxEngine(QObject *parent, GeoDataModel *geoDataModel)
+GpxEngine::GpxEngine(QObject *parent, GeoDataModel *geoDataModel, int trackCacheSize)
     : QObject(parent),
       m_geoDataModel(geoDataModel)
 {
-    // Load the timezone map image
-    const auto timezoneMapFile = QStandardPaths::locate(QStandardPaths::AppDataLocation,
-                                                        QStringLiteral("timezones.png"));
-    if (! timezoneMapFile.isEmpty()) {
-        m_timezoneMap = QImage(timezoneMapFile);
-        if (! m_timezoneMap.isNull()) {
-            m_timezoneMapWidth = m_timezoneMap.size().width();
-            m_timezoneMapHeight = m_timezoneMap.size().height();
-        }
-        qCDebug(KGeoTagLog) << "Loaded the timezones map from" << timezoneMapFile;
-    } else {
-        // This should not happen
-        qCDebug(KGeoTagLog) << "Failed to load the timezones map file!";
-    }
-
-    // Load the color-timezone mapping
-    const auto timezoneMappingFile = QStandardPaths::locate(QStandardPaths::AppDataLocation,
-                                                            QStringLiteral("timezones.json"));
-    if (! timezoneMappingFile.isEmpty()) {
-        QFile jsonData(timezoneMappingFile);
-        if (jsonData.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            const auto jsonDocument = QJsonDocument::fromJson(jsonData.readAll());
-            jsonData.close();
-            m_timezoneMapping = jsonDocument.object();
-        }
-        qCDebug(KGeoTagLog) << "Loaded the timezone mapping data from" << timezoneMappingFile;
-    } else {
-        // This should not happen
-        qCDebug(KGeoTagLog) << "Failed to load the timezone mapping data file!";
-    }
-
-    // Check if all listed timezones are valid
-
-    if (! m_timezoneMapping.isEmpty()) {
-        const auto allTimeZones = QTimeZone::availableTimeZoneIds();
-        const auto keys = m_timezoneMapping.keys();
-
-        QList<QByteArray> invalidIds;
-
-        for (const auto &key : keys) {
-            const auto timeZoneId = m_timezoneMapping.value(key).toString().toUtf8();
-            if (! allTimeZones.contains(timeZoneId)) {
-                invalidIds.append(timeZoneId);
-            }
-        }
-
-        qCDebug(KGeoTagLog) << "Processed" << m_timezoneMapping.count() << "timezone IDs";
-
-        if (invalidIds.count() > 0) {
-            qCWarning(KGeoTagLog) << "Found" << invalidIds.count() << "unusable timezone ID(s)!";
-            qCWarning(KGeoTagLog) << "    The following IDs are not represented in "
-                                  << "QTimeZone::availableTimeZoneIds():";
-            for (const auto &id : invalidIds) {
-                qCWarning(KGeoTagLog) << "   " << id;
-            }
-        }
-
-    } else {
-        // This should not happen
-        qCWarning(KGeoTagLog) << "Could not load any timezone IDs!";
-    }
+    m_trackCache = new TrackCache(this, trackCacheSize);
 }
 
 GpxEngine::LoadInfo GpxEngine::load(const QString &path)
@@ -109,147 +49,94 @@ GpxEngine::LoadInfo GpxEngine::load(const QString &path)
         return { LoadResult::AlreadyLoaded };
     }
 
-    QFile gpxFile(path);
+    TrackLines trackLines;
+    const auto info = readGpx(path, &trackLines);
+    return addTrack(path, info, trackLines);
+}
 
-    if (! gpxFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return { LoadResult::OpenFailed };
+GpxEngine::LoadInfo GpxEngine::addTrack(const QString &path, const LoadInfo &info,
+                                        const TrackLines &trackLines)
+{
+    if (info.result != LoadResult::Okay) {
+        return info;
     }
 
-    QXmlStreamReader xml(&gpxFile);
-
-    double lon = 0.0;
-    double lat = 0.0;
-    double alt = 0.0;
-    QDateTime time;
-
-    QList<QDateTime> segmentTimes;
-    QList<Coordinates> segmentCoordinates;
-
-    QList<QList<Coordinates>> allSegments;
-    QList<QList<QDateTime>> allSegmentTimes;
-
-    bool gpxFound = false;
-    bool trackStartFound = false;
-
-    int tracks = 0;
-    int segments = 0;
-    int points = 0;
-
-    while (! xml.atEnd()) {
-        if (xml.hasError()) {
-            return { LoadResult::XmlError };
-        }
+    // The same file could have been read more than once
+    if (m_geoDataModel->contains(path)) {
+        return { LoadResult::AlreadyLoaded };
+    }
 
-        const QXmlStreamReader::TokenType token = xml.readNext();
-        const auto name = xml.name();
+    // Pass the loaded data to the GeoDataModel
+    m_geoDataModel->addTrack(path, trackLines);
 
-        if (token == QXmlStreamReader::StartElement) {
-            if (! gpxFound) {
-                if (name != s_gpx) {
-                    continue;
-                } else {
-                    gpxFound = true;
-                }
-            }
+    // Detect the presumable timezone the corresponding photos were taken in, using the loaded
+    // path's bounding box's center point
+    const auto trackCenter = m_geoDataModel->trackBoxCenter(path);
+    m_lastDetectedTimeZoneId = m_timeZoneLookup.timeZoneId(trackCenter.lon(), trackCenter.lat());
 
-            if (! trackStartFound) {
-                if (name != s_trk) {
-                    continue;
-                } else {
-                    trackStartFound = true;
-                    tracks++;
-                }
-            }
+    return info;
+}
 
-            if (name == s_trkseg) {
-                segments++;
+GpxEngine::LoadInfo GpxEngine::readGpx(const QString &path, TrackLines *trackLines) const
+{
+    QFile gpxFile(path);
 
-            } else if (name == s_trkpt) {
-                QXmlStreamAttributes attributes = xml.attributes();
-                lon = attributes.value(s_lon).toDouble();
-                lat = attributes.value(s_lat).toDouble();
-                points++;
+    if (! gpxFile.open(QIODevice::ReadOnly)) {
+        return { LoadResult::OpenFailed };
+    }
 
-            } else if (name == s_ele) {
-                xml.readNext();
-                alt = xml.text().toDouble();
+    LoadInfo info { LoadResult::Okay };
+    Track track;
+    QList<float> significances;
 
-            } else if (name == s_time) {
-                xml.readNext();
-                time = QDateTime::fromString(xml.text().toString(), Qt::ISODate);
+    // If we already read this file, we can simply use the cached result. This also includes the
+    // points' significances, so that the track doesn't have to be simplified again.
+    if (m_trackCache->read(path, &track, &significances, &info)) {
+        *trackLines = TrackLines(track, significances);
+        return info;
+    }
 
-                // Strip out milliseconds if the GPX provides them to allow seconds-exact matching
-                const auto msec = time.time().msec();
-                if (msec != 0) {
-                    time = time.addMSecs(msec * -1);
-                }
-            }
+    // Try the fast path first: Scan the mapped file directly. If the scanner can't handle the file,
+    // we parse it using QXmlStreamReader.
 
-        } else if (token == QXmlStreamReader::EndElement) {
-            if (name == s_trkpt) {
-                segmentTimes.append(time);
-                segmentCoordinates.append(Coordinates(lon, lat, alt, true));
-                alt = 0.0;
-                time = QDateTime();
-
-            } else if (name == s_trkseg && ! segmentCoordinates.isEmpty()) {
-                allSegmentTimes.append(segmentTimes);
-                allSegments.append(segmentCoordinates);
-                segmentTimes.clear();
-                segmentCoordinates.clear();
-
-            } else if (name == s_trk) {
-                trackStartFound = false;
-            }
+    bool scanned = false;
+    if (gpxFile.size() > 0) {
+        auto *data = gpxFile.map(0, gpxFile.size());
+        if (data != nullptr) {
+            scanned = GpxScanner::scan(reinterpret_cast<const char *>(data), gpxFile.size(),
+                                       &track, &info);
+            gpxFile.unmap(data);
         }
     }
 
-    if (! gpxFound) {
-        return { LoadResult::NoGpxElement, tracks, segments, points };
+    if (! scanned) {
+        qCDebug(KGeoTagLog) << "Could not scan" << path << "directly, parsing it as XML";
+        track = Track();
+        info = GpxParser::parse(&gpxFile, &track);
+        if (info.result != LoadResult::Okay) {
+            return info;
+        }
     }
 
-    if (points == 0) {
-        return { LoadResult::NoGeoData, tracks, segments, points };
+    if (info.points == 0) {
+        info.result = LoadResult::NoGeoData;
+        return info;
     }
 
     // All okay :-)
-
-    // Pass the loaded data to the GeoDataModel
-    m_geoDataModel->addTrack(path, allSegmentTimes, allSegments);
-
-    // Detect the presumable timezone the corresponding photos were taken in
-
-    // Get the loaded path's bounding box's center point
-    const auto trackCenter = m_geoDataModel->trackBoxCenter(path);
-
-    // Scale the coordinates to the image size, relative to the image center
-    int mappedLon = std::round(trackCenter.lon() / 180.0 * (m_timezoneMapWidth / 2.0));
-    int mappedLat = std::round(trackCenter.lat() / 90.0 * (m_timezoneMapHeight / 2.0));
-
-    // Move the mapped coordinates to the left lower edge
-    mappedLon = m_timezoneMapWidth / 2 + mappedLon;
-    mappedLat = m_timezoneMapHeight - (m_timezoneMapHeight / 2 + mappedLat);
-
-    // Get the respective pixel's color
-    const auto timezoneColor = m_timezoneMap.pixelColor(mappedLon, mappedLat).name();
-
-    // Lookup the corresponding timezone
-    const auto timezoneId = m_timezoneMapping.value(timezoneColor);
-    if (timezoneId.isString()) {
-        m_lastDetectedTimeZoneId = timezoneId.toString().toUtf8();
-    } else {
-        m_lastDetectedTimeZoneId.clear();
-    }
-
-    return { LoadResult::Okay, tracks, segments, points };
+    track.finish();
+    significances = TrackLines::significances(track);
+    *trackLines = TrackLines(track, significances);
+    m_trackCache->store(path, track, significances, info);
+    return info;
 }
 
 void GpxEngine::setMatchParameters(int exactMatchTolerance, int maximumInterpolationInterval,
                                    int maximumInterpolationDistance)
 {
-    m_exactMatchTolerance = exactMatchTolerance;
-    m_maximumInterpolationInterval = maximumInterpolationInterval;
-    m_maximumInterpolationDistance = maximumInterpolationDistance;
+    m_matchParameters.exactMatchTolerance = exactMatchTolerance;
+    m_matchParameters.maximumInterpolationInterval = maximumInterpolationInterval;
+    m_matchParameters.maximumInterpolationDistance = maximumInterpolationDistance;
 }
 
 Coordinates GpxEngine::findExactCoordinates(const QDateTime &time, int deviation) const
@@ -264,28 +151,13 @@ Coordinates GpxEngine::findExactCoordinates(const QDateTime &time, int deviation
 
 Coordinates GpxEngine::findExactCoordinates(const QDateTime &time) const
 {
-    // Iterate over all loaded files we have
-    for (const auto &trackPoints : m_geoDataModel->trackPoints()) {
-        // Check for an exact match
-        if (trackPoints.contains(time)) {
-            return trackPoints.value(time);
-        }
-
-        // Check for a match with +/- the maximum tolerable deviation
-        for (int i = 1; i <= m_exactMatchTolerance; i++) {
-            const auto timeBefore = time.addSecs(i * -1);
-            if (trackPoints.contains(timeBefore)) {
-                return trackPoints.value(timeBefore);
-            }
-            const auto timeAfter = time.addSecs(i);
-            if (trackPoints.contains(timeAfter)) {
-                return trackPoints.value(timeAfter);
-            }
-        }
+    if (! time.isValid()) {
+        return Coordinates();
     }
 
-    // No match found
-    return Coordinates();
+    // Search the closest point of all loaded files within the maximum tolerable deviation
+    return m_geoDataModel->trackPointIndex().findClosest(time.toSecsSinceEpoch(),
+                                                         m_matchParameters.exactMatchTolerance);
 }
 
 Coordinates GpxEngine::findInterpolatedCoordinates(const QDateTime &time, int deviation) const
@@ -300,102 +172,233 @@ Coordinates GpxEngine::findInterpolatedCoordinates(const QDateTime &time, int de
 
 Coordinates GpxEngine::findInterpolatedCoordinates(const QDateTime &time) const
 {
-    // Iterate over all loaded files we have
-    for (int i = 0; i < m_geoDataModel->dateTimes().count(); i++) {
-        const auto &dateTimes = m_geoDataModel->dateTimes().at(i);
-        const auto &trackPoints = m_geoDataModel->trackPoints().at(i);
+    if (! time.isValid()) {
+        return Coordinates();
+    }
+
+    const auto batch = matchSorted(m_geoDataModel->trackData(), m_matchParameters,
+                                   { qMakePair(time.toSecsSinceEpoch(), 0) },
+                                   KGeoTag::InterpolatedMatchSearch);
+    return batch.first().second.coordinates;
+}
+
+Coordinates GpxEngine::interpolate(const MatchParameters &parameters,
+                                   const Coordinates &pointBefore, qint64 timeBefore,
+                                   const Coordinates &pointAfter, qint64 timeAfter, qint64 time)
+{
+    // Check for a maximum time interval between the points if requested
+    if (parameters.maximumInterpolationInterval != -1
+        && timeAfter - timeBefore > parameters.maximumInterpolationInterval) {
+
+        return Coordinates();
+    }
+
+    // Create Marble coordinates for further calculations
+    const auto coordinatesBefore = Marble::GeoDataCoordinates(
+        pointBefore.lon(), pointBefore.lat(), pointBefore.alt(),
+        Marble::GeoDataCoordinates::Degree);
+    const auto coordinatesAfter = Marble::GeoDataCoordinates(
+        pointAfter.lon(), pointAfter.lat(), pointAfter.alt(),
+        Marble::GeoDataCoordinates::Degree);
+
+    // Check for a maximum distance between the points if requested
+
+    if (parameters.maximumInterpolationDistance != -1
+        && coordinatesBefore.sphericalDistanceTo(coordinatesAfter) * KGeoTag::earthRadius
+        > parameters.maximumInterpolationDistance) {
+
+        return Coordinates();
+    }
+
+    // Calculate an interpolated position between the coordinates
+
+    const double fraction = double(time - timeBefore) / double(timeAfter - timeBefore);
+    const auto interpolated = coordinatesBefore.interpolate(coordinatesAfter, fraction);
 
-        // This only works if we at least have at least 2 points ;-)
-        if (dateTimes.count() < 2) {
-            continue;
+    return Coordinates(interpolated.longitude(Marble::GeoDataCoordinates::Degree),
+                       interpolated.latitude(Marble::GeoDataCoordinates::Degree),
+                       interpolated.altitude(),
+                       true);
+}
+
+QList<QPair<qint64, int>> GpxEngine::sortTimes(const QList<QDateTime> &times, int deviation)
+{
+    // Sort the (valid) requested times, remembering where each one came from
+    QList<QPair<qint64, int>> sortedTimes;
+    sortedTimes.reserve(times.count());
+    for (int i = 0; i < times.count(); i++) {
+        const auto &time = times.at(i);
+        if (time.isValid()) {
+            sortedTimes.append(qMakePair(time.toSecsSinceEpoch() + deviation, i));
         }
+    }
+    std::stable_sort(sortedTimes.begin(), sortedTimes.end());
+    return sortedTimes;
+}
+
+GpxEngine::MatchBatch GpxEngine::matchSorted(const GeoDataModel::TrackData &tracks,
+                                             const MatchParameters &parameters,
+                                             QList<QPair<qint64, int>> sortedTimes,
+                                             KGeoTag::SearchType searchType)
+{
+    // This is a linear walk through the sorted times and the sorted trackpoints. It only uses
+    // the passed data, so that it can safely be run in another thread.
+
+    MatchBatch results;
+    results.reserve(sortedTimes.count());
+
+    // Search for exact matches if requested
 
-        // If the image's date is before the first or after the last point we have,
-        // it can't be assigned.
-        if (time < dateTimes.first() || time > dateTimes.last()) {
-            continue;
+    if (searchType == KGeoTag::CombinedMatchSearch || searchType == KGeoTag::ExactMatchSearch) {
+        QList<qint64> seconds;
+        seconds.reserve(sortedTimes.count());
+        for (const auto &entry : std::as_const(sortedTimes)) {
+            seconds.append(entry.first);
         }
 
-        // Check for an exact match (without tolerance)
-        // This also eliminates the case that the time could be the first one.
-        // We thus can be sure the first entry in dateTimes is earlier than the time requested.
-        if (dateTimes.contains(time)) {
-            return trackPoints.value(time);
+        const auto exactMatches = tracks.trackPointIndex.findClosest(
+            seconds, parameters.exactMatchTolerance);
+
+        QList<QPair<qint64, int>> unmatched;
+        for (int i = 0; i < sortedTimes.count(); i++) {
+            const auto &coordinates = exactMatches.at(i);
+            if (coordinates.isSet()) {
+                results.append(qMakePair(sortedTimes.at(i).second,
+                                         MatchResult { coordinates, KGeoTag::ExactMatch }));
+            } else {
+                unmatched.append(sortedTimes.at(i));
+            }
         }
+        sortedTimes = unmatched;
+    }
 
-        // Search for the first time earlier than the image's
+    // Search for interpolated matches if requested
 
-        int start = 0;
-        int end = dateTimes.count() - 1;
-        int index = 0;
-        int lastIndex = -1;
+    if (searchType == KGeoTag::CombinedMatchSearch
+        || searchType == KGeoTag::InterpolatedMatchSearch) {
 
-        while (true) {
-            index = start + (end - start) / 2;
-            if (index == lastIndex) {
+        // Iterate over all loaded files we have
+        for (const auto &track : tracks.tracks) {
+            if (sortedTimes.isEmpty()) {
                 break;
             }
 
-            if (dateTimes.at(index) > time) {
-                end = index;
-            } else {
-                start = index;
+            // Points without a (valid) timestamp are sorted to the front and can't be used
+            const int firstValid = track.firstTimedPoint();
+            const int lastValid = track.count() - 1;
+
+            // This only works if we at least have at least 2 points ;-)
+            if (lastValid - firstValid < 1) {
+                continue;
             }
 
-            lastIndex = index;
-        }
+            const auto secondsAt = [&track](int index)
+            {
+                return track.sortedTime(index);
+            };
+            const auto pointAt = [&track](int index)
+            {
+                return track.sortedCoordinates(index);
+            };
 
-        // If the found point is the last one, we can't interpolate and use it directly
-        const auto &closestBefore = dateTimes.at(index);
-        if (closestBefore == dateTimes.last()) {
-            return trackPoints.value(closestBefore);
-        }
+            const auto firstTime = secondsAt(firstValid);
+            const auto lastTime = secondsAt(lastValid);
 
-        // Interpolate between the two coordinates
+            // Start with the last point not later than the first requested time
+            int before = std::max(track.sortedUpperBound(sortedTimes.first().first) - 1,
+                                  firstValid);
 
-        const auto &closestAfter = dateTimes.at(index + 1);
+            QList<QPair<qint64, int>> unmatched;
 
-        // Check for a maximum time interval between the points if requested
-        if (m_maximumInterpolationInterval != -1
-            && closestBefore.secsTo(closestAfter) > m_maximumInterpolationInterval) {
+            for (const auto &entry : std::as_const(sortedTimes)) {
+                const auto time = entry.first;
 
-            continue;
-        }
+                // If the image's date is before the first or after the last point we have,
+                // it can't be assigned.
+                if (time < firstTime || time > lastTime) {
+                    unmatched.append(entry);
+                    continue;
+                }
 
-        // Create Marble coordinates from the cache for further calculations
-        const auto &pointBefore = trackPoints[closestBefore];
-        const auto &pointAfter = trackPoints[closestAfter];
-        const auto coordinatesBefore = Marble::GeoDataCoordinates(
-            pointBefore.lon(), pointBefore.lat(), pointBefore.alt(),
-            Marble::GeoDataCoordinates::Degree);
-        const auto coordinatesAfter = Marble::GeoDataCoordinates(
-            pointAfter.lon(), pointAfter.lat(), pointAfter.alt(),
-            Marble::GeoDataCoordinates::Degree);
+                // Move on to the last point not later than the image's date
+                while (before < lastValid && secondsAt(before + 1) <= time) {
+                    before++;
+                }
 
-        // Check for a maximum distance between the points if requested
+                Coordinates coordinates;
+                if (before == lastValid || secondsAt(before) == time) {
+                    // Exact match (without tolerance), or the last point, which we can't
+                    // interpolate with anything and thus use directly
+                    coordinates = pointAt(before);
+                } else {
+                    coordinates = interpolate(parameters,
+                                              pointAt(before), secondsAt(before),
+                                              pointAt(before + 1), secondsAt(before + 1),
+                                              time);
+                }
 
-        if (m_maximumInterpolationDistance != -1
-            && coordinatesBefore.sphericalDistanceTo(coordinatesAfter) * KGeoTag::earthRadius
-            > m_maximumInterpolationDistance) {
+                if (coordinates.isSet()) {
+                    results.append(qMakePair(entry.second,
+                                             MatchResult { coordinates,
+                                                           KGeoTag::InterpolatedMatch }));
+                } else {
+                    unmatched.append(entry);
+                }
+            }
 
-            continue;
+            sortedTimes = unmatched;
         }
+    }
+
+    // Everything that's left could not be matched
+    for (const auto &entry : std::as_const(sortedTimes)) {
+        results.append(qMakePair(entry.second, MatchResult()));
+    }
+
+    return results;
+}
+
+QList<GpxEngine::MatchResult> GpxEngine::matchAll(const QList<QDateTime> &times, int deviation,
+                                                  KGeoTag::SearchType searchType) const
+{
+    QList<MatchResult> results(times.count());
+
+    const auto batch = matchSorted(m_geoDataModel->trackData(), m_matchParameters,
+                                   sortTimes(times, deviation), searchType);
+    for (const auto &[ index, result ] : batch) {
+        results[index] = result;
+    }
 
-        // Calculate an interpolated position between the coordinates
+    return results;
+}
 
-        const int secondsBefore = closestBefore.secsTo(time);
-        const double fraction = double(secondsBefore)
-                                / double(secondsBefore + time.secsTo(closestAfter));
-        const auto interpolated = coordinatesBefore.interpolate(coordinatesAfter, fraction);
+QFuture<GpxEngine::MatchBatch> GpxEngine::matchAllConcurrently(const QList<QDateTime> &times,
+                                                               int deviation,
+                                                               KGeoTag::SearchType searchType)
+                                                               const
+{
+    // Split the sorted times into consecutive time ranges, so that each worker only walks
+    // through its own part of the tracks
 
-        return Coordinates(interpolated.longitude(Marble::GeoDataCoordinates::Degree),
-                        interpolated.latitude(Marble::GeoDataCoordinates::Degree),
-                        interpolated.altitude(),
-                        true);
+    const auto sortedTimes = sortTimes(times, deviation);
+    const int chunkSize = std::max(s_minimumMatchChunkSize,
+        int(sortedTimes.count() / (QThread::idealThreadCount() * 4)) + 1);
+
+    QList<QList<QPair<qint64, int>>> chunks;
+    for (int i = 0; i < sortedTimes.count(); i += chunkSize) {
+        chunks.append(sortedTimes.mid(i, chunkSize));
     }
 
-    // No match found
-    return Coordinates();
+    // The workers get their own (implicitly shared) copy of the track data and the parameters,
+    // so that nothing they use can change while they are running
+    const auto tracks = m_geoDataModel->trackData();
+    const auto parameters = m_matchParameters;
+
+    return QtConcurrent::mapped(std::move(chunks),
+        [tracks, parameters, searchType](const QList<QPair<qint64, int>> &chunk)
+        {
+            return matchSorted(tracks, parameters, chunk, searchType);
+        });
 }
 
 QByteArray GpxEngine::lastDetectedTimeZoneId() const
@@ -403,9 +406,14 @@ QByteArray GpxEngine::lastDetectedTimeZoneId() const
     return m_lastDetectedTimeZoneId;
 }
 
+QByteArray GpxEngine::timeZoneId(const Coordinates &coordinates) const
+{
+    return m_timeZoneLookup.timeZoneId(coordinates.lon(), coordinates.lat());
+}
+
 bool GpxEngine::timeZoneDataLoaded() const
 {
-    return ! m_timezoneMap.isNull() && ! m_timezoneMapping.isEmpty();
+    return m_timeZoneLookup.isAvailable();
 }
 
 QPair<Coordinates, QDateTime> GpxEngine::findClosestTrackPoint(QDateTime time,
@@ -417,32 +425,36 @@ QPair<Coordinates, QDateTime> GpxEngine::findClosestTrackPoint(QDateTime time,
 
     auto coordinates = Coordinates();
     auto pointTime = QDateTime();
-    auto deviation = -1;
+
+    if (! time.isValid()) {
+        return QPair<Coordinates, QDateTime>(coordinates, pointTime);
+    }
+
+    const auto seconds = time.toSecsSinceEpoch();
+    qint64 deviation = -1;
 
     // Iterate over all loaded files we have
-    for (const auto &trackPoints : m_geoDataModel->trackPoints()) {
-        if (deviation == -1) {
-            // Initialize the deviation with the first point
-            const auto it = trackPoints.constBegin();
-            deviation = std::abs(it.key().secsTo(time));
-            pointTime = it.key();
-            coordinates = it.value();
-        }
+    for (const auto &track : m_geoDataModel->tracks()) {
+        // The closest point is either the last one not later than the requested time or the one
+        // following it
+        const int after = track.sortedUpperBound(seconds);
+        for (const int index : { after - 1, after }) {
+            if (index < track.firstTimedPoint() || index >= track.count()) {
+                continue;
+            }
 
-        // Check for an exact match
-        if (trackPoints.contains(time)) {
-            return QPair<Coordinates, QDateTime>(trackPoints.value(time), time);
+            const auto currentDeviation = std::abs(track.sortedTime(index) - seconds);
+            if (deviation == -1 || currentDeviation < deviation) {
+                deviation = currentDeviation;
+                pointTime = QDateTime::fromSecsSinceEpoch(track.sortedTime(index),
+                                                          QTimeZone::utc());
+                coordinates = track.sortedCoordinates(index);
+            }
         }
 
-        // Check for the time deviation of each point
-        QHash<QDateTime, Coordinates>::const_iterator it;
-        for (it = trackPoints.constBegin(); it != trackPoints.constEnd(); it++) {
-            const auto currentDeviaton = std::abs(it.key().secsTo(time));
-            if (currentDeviaton < deviation) {
-                deviation = currentDeviaton;
-                pointTime = it.key();
-                coordinates = it.value();
-            }
+        // Check for an exact match
+        if (deviation == 0) {
+            break;
         }
     }
 
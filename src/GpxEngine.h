@@ -8,16 +8,19 @@
 // Local includes
 #include "KGeoTag.h"
 #include "Coordinates.h"
+#include "GeoDataModel.h"
+#include "TimeZoneLookup.h"
 
 // Qt includes
 #include <QObject>
 #include <QHash>
 #include <QDateTime>
-#include <QImage>
-#include <QJsonObject>
+#include <QFuture>
 
 // Local classes
-class GeoDataModel;
+class Track;
+class TrackLines;
+class TrackCache;
 
 class GpxEngine : public QObject
 {
@@ -41,32 +44,66 @@ public:
         int points = 0;
     };
 
-    explicit GpxEngine(QObject *parent, GeoDataModel *geoDataModel);
+    struct MatchResult
+    {
+        Coordinates coordinates;
+        KGeoTag::MatchType matchType = KGeoTag::NotMatched;
+    };
+
+    // Match results, along with the index of the respective requested time
+    typedef QList<QPair<int, MatchResult>> MatchBatch;
+
+    explicit GpxEngine(QObject *parent, GeoDataModel *geoDataModel, int trackCacheSize);
     GpxEngine::LoadInfo load(const QString &path);
+
+    // Loading a file can be split up: readGpx reads the file and prepares the track for drawing
+    // it. It's thread-safe, so that this can be done in a worker thread. addTrack has to be called
+    // on the main thread to add the read track.
+    LoadInfo readGpx(const QString &path, TrackLines *trackLines) const;
+    GpxEngine::LoadInfo addTrack(const QString &path, const LoadInfo &info,
+                                 const TrackLines &trackLines);
+
     Coordinates findExactCoordinates(const QDateTime &time, int deviation) const;
     Coordinates findInterpolatedCoordinates(const QDateTime &time, int deviation) const;
+    QList<MatchResult> matchAll(const QList<QDateTime> &times, int deviation,
+                                KGeoTag::SearchType searchType) const;
+    QFuture<MatchBatch> matchAllConcurrently(const QList<QDateTime> &times, int deviation,
+                                             KGeoTag::SearchType searchType) const;
     QPair<Coordinates, QDateTime> findClosestTrackPoint(QDateTime time,
                                                         int cameraClockDeviation) const;
     void setMatchParameters(int exactMatchTolerance, int maximumInterpolationInterval,
                             int maximumInterpolationDistance);
     QByteArray lastDetectedTimeZoneId() const;
+    QByteArray timeZoneId(const Coordinates &coordinates) const;
     bool timeZoneDataLoaded() const;
 
+private: // Structs
+    struct MatchParameters
+    {
+        int exactMatchTolerance = 0;
+        int maximumInterpolationInterval = -1;
+        int maximumInterpolationDistance = -1;
+    };
+
 private: // Functions
     Coordinates findExactCoordinates(const QDateTime &time) const;
     Coordinates findInterpolatedCoordinates(const QDateTime &time) const;
+    static Coordinates interpolate(const MatchParameters &parameters,
+                                   const Coordinates &pointBefore, qint64 timeBefore,
+                                   const Coordinates &pointAfter, qint64 timeAfter, qint64 time);
+    static QList<QPair<qint64, int>> sortTimes(const QList<QDateTime> &times, int deviation);
+    static MatchBatch matchSorted(const GeoDataModel::TrackData &tracks,
+                                  const MatchParameters &parameters,
+                                  QList<QPair<qint64, int>> sortedTimes,
+                                  KGeoTag::SearchType searchType);
 
 private: // Variables
     GeoDataModel *m_geoDataModel;
+    TrackCache *m_trackCache;
 
-    int m_exactMatchTolerance;
-    int m_maximumInterpolationInterval;
-    int m_maximumInterpolationDistance;
+    MatchParameters m_matchParameters;
 
-    QImage m_timezoneMap;
-    double m_timezoneMapWidth = 0.0;
-    double m_timezoneMapHeight = 0.0;
-    QJsonObject m_timezoneMapping;
+    TimeZoneLookup m_timeZoneLookup;
     QByteArray m_lastDetectedTimeZoneId;
 
 };
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "GpxParser.h"
+#include "Track.h"
+#include "IsoDateTime.h"
+
+// Qt includes
+#include <QIODevice>
+#include <QXmlStreamReader>
+
+namespace GpxParser
+{
+
+static const auto s_gpx    = QStringLiteral("gpx");
+static const auto s_trk    = QStringLiteral("trk");
+static const auto s_trkpt  = QStringLiteral("trkpt");
+static const auto s_lon    = QStringLiteral("lon");
+static const auto s_lat    = QStringLiteral("lat");
+static const auto s_ele    = QStringLiteral("ele");
+static const auto s_time   = QStringLiteral("time");
+static const auto s_trkseg = QStringLiteral("trkseg");
+
+GpxEngine::LoadInfo parse(QIODevice *device, Track *track)
+{
+    device->seek(0);
+    QXmlStreamReader xml(device);
+
+    double lon = 0.0;
+    double lat = 0.0;
+    double alt = 0.0;
+    qint64 time = Track::invalidTime;
+
+    bool gpxFound = false;
+    bool trackStartFound = false;
+
+    int tracks = 0;
+    int segments = 0;
+    int points = 0;
+
+    while (! xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        const auto name = xml.name();
+
+        if (token == QXmlStreamReader::StartElement) {
+            if (! gpxFound) {
+                if (name != s_gpx) {
+                    continue;
+                } else {
+                    gpxFound = true;
+                }
+            }
+
+            if (! trackStartFound) {
+                if (name != s_trk) {
+                    continue;
+                } else {
+                    trackStartFound = true;
+                    tracks++;
+                }
+            }
+
+            if (name == s_trkseg) {
+                track->startSegment();
+                segments++;
+
+            } else if (name == s_trkpt) {
+                QXmlStreamAttributes attributes = xml.attributes();
+                lon = attributes.value(s_lon).toDouble();
+                lat = attributes.value(s_lat).toDouble();
+                points++;
+
+            } else if (name == s_ele) {
+                xml.readNext();
+                alt = xml.text().toDouble();
+
+            } else if (name == s_time) {
+                xml.readNext();
+                // We only use whole seconds (possibly present milliseconds are dropped) to allow
+                // seconds-exact matching
+                if (! IsoDateTime::toSecsSinceEpoch(xml.text(), &time)) {
+                    time = Track::invalidTime;
+                }
+            }
+
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (name == s_trkpt) {
+                track->appendPoint(time, lon, lat, alt);
+                alt = 0.0;
+                time = Track::invalidTime;
+
+            } else if (name == s_trk) {
+                trackStartFound = false;
+            }
+        }
+    }
+
+    // atEnd() also returns true if an error occurred
+    if (xml.hasError()) {
+        return { GpxEngine::XmlError };
+    }
+
+    if (! gpxFound) {
+        return { GpxEngine::NoGpxElement, tracks, segments, points };
+    }
+
+    return { GpxEngine::Okay, tracks, segments, points };
+}
+
+}
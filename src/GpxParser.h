@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef GPXPARSER_H
+#define GPXPARSER_H
+
+// Local includes
+#include "GpxEngine.h"
+
+// Local classes
+class Track;
+
+// Qt classes
+class QIODevice;
+
+namespace GpxParser
+{
+
+// Parses a GPX file using QXmlStreamReader and adds the track points found to the track. This
+// handles everything GpxScanner can't, like other encodings, CDATA sections or entities.
+GpxEngine::LoadInfo parse(QIODevice *device, Track *track);
+
+}
+
+#endif // GPXPARSER_H
@@ -0,0 +1,406 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "GpxScanner.h"
+#include "Track.h"
+#include "IsoDateTime.h"
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+// C++ includes
+#include <string_view>
+
+namespace GpxScanner
+{
+
+static constexpr auto s_notFound = std::string_view::npos;
+
+// Timestamps longer than this are converted via QString
+static constexpr int s_maximumTimeLength = 64;
+
+static bool isSpace(char character)
+{
+    return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+}
+
+static std::string_view trimmed(std::string_view text)
+{
+    while (! text.empty() && isSpace(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (! text.empty() && isSpace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+static bool equalsIgnoringCase(std::string_view text, std::string_view lowerCase)
+{
+    if (text.size() != lowerCase.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < text.size(); i++) {
+        char character = text[i];
+        if (character >= 'A' && character <= 'Z') {
+            character += 'a' - 'A';
+        }
+        if (character != lowerCase[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns the position of the '>' closing the tag starting at the given position. Attribute values
+// may contain a '>', so we have to skip them.
+static size_t tagEnd(std::string_view data, size_t position)
+{
+    while (position < data.size()) {
+        const char character = data[position];
+        if (character == '>') {
+            return position;
+        }
+        if (character == '"' || character == '\'') {
+            position = data.find(character, position + 1);
+            if (position == s_notFound) {
+                return s_notFound;
+            }
+        }
+        position++;
+    }
+
+    return s_notFound;
+}
+
+// Strips a namespace prefix, like QXmlStreamReader::name() does
+static std::string_view localName(std::string_view name)
+{
+    const auto colon = name.find(':');
+    return colon == s_notFound ? name : name.substr(colon + 1);
+}
+
+// Searches a tag's attributes for the given ones and sets the values found. Returns false if the
+// attributes are malformed or contain entity references.
+template<size_t count>
+static bool readAttributes(std::string_view attributes, const std::string_view (&names)[count],
+                           std::string_view (&values)[count])
+{
+    size_t position = 0;
+
+    while (true) {
+        while (position < attributes.size() && isSpace(attributes[position])) {
+            position++;
+        }
+        if (position == attributes.size()) {
+            return true;
+        }
+
+        const auto equalsSign = attributes.find('=', position);
+        if (equalsSign == s_notFound) {
+            return false;
+        }
+        const auto name = trimmed(attributes.substr(position, equalsSign - position));
+
+        position = equalsSign + 1;
+        while (position < attributes.size() && isSpace(attributes[position])) {
+            position++;
+        }
+        if (position == attributes.size()
+            || (attributes[position] != '"' && attributes[position] != '\'')) {
+
+            return false;
+        }
+
+        const auto valueEnd = attributes.find(attributes[position], position + 1);
+        if (valueEnd == s_notFound) {
+            return false;
+        }
+        const auto value = attributes.substr(position + 1, valueEnd - position - 1);
+        if (value.find('&') != s_notFound) {
+            return false;
+        }
+        position = valueEnd + 1;
+
+        for (size_t i = 0; i < count; i++) {
+            if (name == names[i]) {
+                values[i] = value;
+            }
+        }
+    }
+}
+
+static double toDouble(std::string_view text)
+{
+    // QByteArray::toDouble always uses the C locale, in contrast to strtod. Just like
+    // QStringView::toDouble (as used by the QXmlStreamReader code path), we get 0 for invalid
+    // values.
+    return QByteArray::fromRawData(text.data(), qsizetype(text.size())).toDouble();
+}
+
+static qint64 toTime(std::string_view text)
+{
+    qint64 time;
+
+    // Timestamps are plain ASCII in practice, so that we can convert them without allocating
+    // anything
+    char16_t buffer[s_maximumTimeLength];
+    bool isAscii = text.size() <= size_t(s_maximumTimeLength);
+    for (size_t i = 0; isAscii && i < text.size(); i++) {
+        isAscii = static_cast<unsigned char>(text[i]) < 0x80;
+        buffer[i] = char16_t(text[i]);
+    }
+
+    if (isAscii) {
+        if (IsoDateTime::toSecsSinceEpoch(QStringView(buffer, qsizetype(text.size())), &time)) {
+            return time;
+        }
+    } else if (IsoDateTime::toSecsSinceEpoch(
+                   QString::fromUtf8(text.data(), qsizetype(text.size())), &time)) {
+        return time;
+    }
+
+    return Track::invalidTime;
+}
+
+bool scan(const char *rawData, qint64 size, Track *track, GpxEngine::LoadInfo *info)
+{
+    static const std::string_view coordinateNames[] = { "lon", "lat" };
+
+    std::string_view data(rawData, size_t(size));
+
+    // UTF-16 and UTF-32 encoded files are left to QXmlStreamReader
+    if (data.substr(0, 2) == "\xFF\xFE" || data.substr(0, 2) == "\xFE\xFF"
+        || data.substr(0, 4).find('\0') != s_notFound) {
+
+        return false;
+    }
+
+    // Skip a UTF-8 byte order mark
+    if (data.substr(0, 3) == "\xEF\xBB\xBF") {
+        data.remove_prefix(3);
+    }
+
+    // Check the declared encoding. Only UTF-8 (and ASCII, which is a subset of it) is handled here.
+    if (data.substr(0, 5) == "<?xml") {
+        const auto declarationEnd = data.find("?>");
+        if (declarationEnd == s_notFound) {
+            return false;
+        }
+
+        const std::string_view names[] = { "encoding" };
+        std::string_view values[1];
+        if (! readAttributes(data.substr(5, declarationEnd - 5), names, values)) {
+            return false;
+        }
+
+        const auto encoding = values[0];
+        if (! encoding.empty() && ! equalsIgnoringCase(encoding, "utf-8")
+            && ! equalsIgnoringCase(encoding, "us-ascii")) {
+
+            return false;
+        }
+    }
+
+    // This follows the QXmlStreamReader code path in GpxParser: Everything before the gpx element
+    // and everything outside of trk elements is skipped. Malformed XML makes us bail out, so that
+    // QXmlStreamReader can report the error.
+
+    double lon = 0.0;
+    double lat = 0.0;
+    double alt = 0.0;
+    qint64 time = Track::invalidTime;
+
+    bool gpxFound = false;
+    bool trackStartFound = false;
+
+    size_t position = 0;
+
+    // The qualified names of the elements that have been opened but not closed yet
+    QList<std::string_view> openElements;
+
+    // Processes an end tag. Returns true if the gpx element has been closed.
+    auto endElement = [&](std::string_view name)
+    {
+        if (name == "trkpt") {
+            track->appendPoint(time, lon, lat, alt);
+            alt = 0.0;
+            time = Track::invalidTime;
+        } else if (name == "trk") {
+            trackStartFound = false;
+        } else if (name == "gpx") {
+            return true;
+        }
+        return false;
+    };
+
+    while (true) {
+        // All searching is done via std::string_view::find, which boils down to memchr and thus
+        // to a vectorized byte search
+        const auto tagStart = data.find('<', position);
+        if (tagStart == s_notFound || tagStart + 1 == data.size()) {
+            // The gpx element has not been closed. We leave it to QXmlStreamReader to report this.
+            return false;
+        }
+        position = tagStart + 1;
+
+        if (data[position] == '?') {
+            // A processing instruction
+            const auto end = data.find("?>", position);
+            if (end == s_notFound) {
+                return false;
+            }
+            position = end + 2;
+            continue;
+        }
+
+        if (data[position] == '!') {
+            if (data.substr(position, 3) == "!--") {
+                const auto end = data.find("-->", position + 3);
+                if (end == s_notFound) {
+                    return false;
+                }
+                position = end + 3;
+                continue;
+            }
+
+            // A CDATA section or a DOCTYPE (which could define entities)
+            return false;
+        }
+
+        const bool isEndTag = data[position] == '/';
+        if (isEndTag) {
+            position++;
+        }
+
+        const auto end = tagEnd(data, position);
+        if (end == s_notFound) {
+            return false;
+        }
+        auto tag = data.substr(position, end - position);
+        position = end + 1;
+
+        const bool isEmptyElement = ! isEndTag && ! tag.empty() && tag.back() == '/';
+        if (isEmptyElement) {
+            tag.remove_suffix(1);
+        }
+
+        size_t nameEnd = 0;
+        while (nameEnd < tag.size() && ! isSpace(tag[nameEnd])) {
+            nameEnd++;
+        }
+        const auto qualifiedName = tag.substr(0, nameEnd);
+        const auto name = localName(qualifiedName);
+        if (name.empty()) {
+            return false;
+        }
+
+        if (isEndTag) {
+            // Each end tag has to close the element opened last
+            if (openElements.isEmpty() || openElements.last() != qualifiedName) {
+                return false;
+            }
+            openElements.removeLast();
+
+            if (endElement(name)) {
+                break;
+            }
+            continue;
+        }
+
+        if (! isEmptyElement) {
+            openElements.append(qualifiedName);
+        }
+
+        if (! gpxFound) {
+            if (name != "gpx") {
+                continue;
+            } else {
+                gpxFound = true;
+            }
+        }
+
+        if (! trackStartFound) {
+            if (name != "trk") {
+                continue;
+            } else {
+                trackStartFound = true;
+                info->tracks++;
+            }
+        }
+
+        if (name == "trkseg") {
+            track->startSegment();
+            info->segments++;
+
+        } else if (name == "trkpt") {
+            std::string_view values[2];
+            if (! readAttributes(tag.substr(nameEnd), coordinateNames, values)) {
+                return false;
+            }
+            lon = toDouble(values[0]);
+            lat = toDouble(values[1]);
+            info->points++;
+
+        } else if (name == "ele" || name == "time") {
+            std::string_view text;
+            if (! isEmptyElement) {
+                const auto textEnd = data.find('<', position);
+                if (textEnd == s_notFound) {
+                    return false;
+                }
+                text = data.substr(position, textEnd - position);
+                position = textEnd;
+
+                // Entity or character references. Anything but the end tag following the text
+                // (like child elements or comments) is also left to QXmlStreamReader.
+                if (text.find('&') != s_notFound || data.substr(textEnd, 2) != "</") {
+                    return false;
+                }
+            }
+
+            if (name == "ele") {
+                alt = toDouble(text);
+            } else {
+                time = toTime(text);
+            }
+
+            // The end tag only has to be checked
+            continue;
+        }
+
+        // An empty element has no end tag
+        if (isEmptyElement && endElement(name)) {
+            break;
+        }
+    }
+
+    // Anything but comments or processing instructions after the gpx element would be an error,
+    // which we leave to QXmlStreamReader to report
+    position = data.find('<', position);
+    while (position != s_notFound) {
+        std::string_view end;
+        if (data.substr(position, 4) == "<!--") {
+            end = "-->";
+        } else if (data.substr(position, 2) == "<?") {
+            end = "?>";
+        } else {
+            return false;
+        }
+        position = data.find(end, position);
+        if (position == s_notFound) {
+            return false;
+        }
+        position = data.find('<', position + end.size());
+    }
+
+    return gpxFound;
+}
+
+}
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef GPXSCANNER_H
+#define GPXSCANNER_H
+
+// Local includes
+#include "GpxEngine.h"
+
+// Local classes
+class Track;
+
+namespace GpxScanner
+{
+
+// A fast path for loading GPX files: The UTF-8 data is scanned directly for the track points,
+// without decoding it and without a full XML parse. The points found are added to the track.
+// Returns false if the data contains anything the scanner can't handle. In this case, the data has
+// to be parsed by GpxParser, and the track and info have to be discarded.
+bool scan(const char *data, qint64 size, Track *track, GpxEngine::LoadInfo *info);
+
+}
+
+#endif // GPXSCANNER_H
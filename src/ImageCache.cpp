@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "ImageCache.h"
+#include "Logging.h"
+
+// Qt includes
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QMutexLocker>
+
+static const quint32 s_magic = 0x4B475443; // "KGTC"
+static const quint32 s_version = 1;
+
+// When the cache grows too big, we delete the least recently used entries until it's this much of
+// the maximum size again, so that we don't have to clean up again with the next image
+static const double s_evictionTarget = 0.9;
+
+static const int s_previewQuality = 90;
+
+static QByteArray encodeImage(const QImage &image, const char *format, int quality = -1)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format, quality);
+    return data;
+}
+
+ImageCache::ImageCache(QObject *parent, int thumbnailSize, int previewSize,
+                       bool useEmbeddedPreviews, int maximumSize)
+    : QObject(parent),
+      m_thumbnailSize(thumbnailSize),
+      m_previewSize(previewSize),
+      m_useEmbeddedPreviews(useEmbeddedPreviews),
+      m_maximumSize(qint64(maximumSize) * 1024 * 1024)
+{
+    if (m_maximumSize == 0) {
+        return;
+    }
+
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                  + QStringLiteral("/images");
+    if (! QDir().mkpath(m_directory)) {
+        qCWarning(KGeoTagLog) << "Could not create the image cache directory" << m_directory;
+        m_directory.clear();
+    }
+}
+
+bool ImageCache::isEnabled() const
+{
+    return ! m_directory.isEmpty();
+}
+
+QString ImageCache::cacheFile(const QString &path) const
+{
+    // Each entry is identified by the image file's path, its size and its mtime, so that a
+    // changed or replaced file never gets an outdated entry. The thumbnail and preview size are
+    // part of the key, too, as well as whether the images have been created from the embedded
+    // previews or from the full image. Outdated entries are never read again and will be evicted
+    // eventually.
+
+    const QFileInfo info(path);
+    const auto canonicalPath = info.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        return QString();
+    }
+
+    const auto key = QStringLiteral("%1\n%2\n%3\n%4\n%5\n%6").arg(
+        canonicalPath,
+        QString::number(info.lastModified().toMSecsSinceEpoch()),
+        QString::number(info.size()),
+        QString::number(m_thumbnailSize),
+        QString::number(m_previewSize),
+        m_useEmbeddedPreviews ? QStringLiteral("embedded") : QStringLiteral("full"));
+
+    return m_directory + QLatin1Char('/')
+           + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(),
+                                                          QCryptographicHash::Sha1).toHex());
+}
+
+QImage ImageCache::thumbnail(const QString &path)
+{
+    return read(path, false);
+}
+
+QImage ImageCache::preview(const QString &path)
+{
+    return read(path, true);
+}
+
+QImage ImageCache::read(const QString &path, bool preview)
+{
+    if (! isEnabled()) {
+        return QImage();
+    }
+
+    const auto fileName = cacheFile(path);
+    if (fileName.isEmpty()) {
+        return QImage();
+    }
+
+    QFile file(fileName);
+    if (! file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (magic != s_magic || version != s_version) {
+        return QImage();
+    }
+
+    // The thumbnail is stored first, followed by the preview
+    QByteArray data;
+    stream >> data;
+    if (preview) {
+        stream >> data;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return QImage();
+    }
+
+    // Mark the entry as recently used, so that it's evicted last
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    return QImage::fromData(data);
+}
+
+void ImageCache::store(const QString &path, const QImage &thumbnail, const QImage &preview)
+{
+    if (! isEnabled()) {
+        return;
+    }
+
+    const auto fileName = cacheFile(path);
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // The thumbnail is small, so we can afford to keep it lossless. The preview is only displayed
+    // scaled, so a JPEG is good enough (and a lot smaller).
+    const auto thumbnailData = encodeImage(thumbnail, "PNG");
+    const auto previewData = preview.hasAlphaChannel()
+        ? encodeImage(preview, "PNG") : encodeImage(preview, "JPG", s_previewQuality);
+
+    QSaveFile file(fileName);
+    if (! file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_magic << s_version << thumbnailData << previewData;
+    const auto size = file.size();
+    if (! file.commit()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_currentSize == -1) {
+        // We didn't check the cache's size yet in this session. This also includes the file we
+        // just wrote.
+        evict();
+    } else {
+        m_currentSize += size;
+        if (m_currentSize > m_maximumSize) {
+            evict();
+        }
+    }
+}
+
+void ImageCache::evict()
+{
+    // This has to be called with m_mutex being locked
+
+    const auto entries = QDir(m_directory).entryInfoList(QDir::Files,
+                                                         QDir::Time | QDir::Reversed);
+
+    m_currentSize = 0;
+    for (const auto &entry : entries) {
+        m_currentSize += entry.size();
+    }
+
+    if (m_currentSize <= m_maximumSize) {
+        return;
+    }
+
+    // The entries are sorted by their mtime, the least recently used one first
+    const auto targetSize = qint64(double(m_maximumSize) * s_evictionTarget);
+    for (const auto &entry : entries) {
+        if (m_currentSize <= targetSize) {
+            break;
+        }
+        if (QFile::remove(entry.filePath())) {
+            m_currentSize -= entry.size();
+        }
+    }
+
+    qCDebug(KGeoTagLog) << "Evicted image cache entries, the cache now uses" << m_currentSize
+                        << "bytes";
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+// Qt includes
+#include <QObject>
+#include <QMutex>
+#include <QImage>
+
+class ImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageCache(QObject *parent, int thumbnailSize, int previewSize,
+                        bool useEmbeddedPreviews, int maximumSize);
+    bool isEnabled() const;
+    QImage thumbnail(const QString &path);
+    QImage preview(const QString &path);
+    void store(const QString &path, const QImage &thumbnail, const QImage &preview);
+
+private: // Functions
+    QString cacheFile(const QString &path) const;
+    QImage read(const QString &path, bool preview);
+    void evict();
+
+private: // Variables
+    // The thumbnail and preview size and the preview source the cached images have been created
+    // for
+    const int m_thumbnailSize;
+    const int m_previewSize;
+    const bool m_useEmbeddedPreviews;
+
+    // In bytes. 0 disables the cache.
+    const qint64 m_maximumSize;
+
+    QString m_directory;
+
+    // lookup and store are called from the image loading threads
+    QMutex m_mutex;
+    qint64 m_currentSize = -1;
+
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "ImageLoader.h"
+
+// Qt includes
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+
+// C++ includes
+#include <algorithm>
+
+ImageLoader::ImageLoader(QObject *parent, const ImagesModel *imagesModel)
+    : QObject(parent),
+      m_imagesModel(imagesModel)
+{
+    m_maximumJobs = std::max(QThreadPool::globalInstance()->maxThreadCount(), 1) * 2;
+}
+
+void ImageLoader::load(const QList<QString> &paths)
+{
+    m_aborted = false;
+    m_finished = false;
+    m_queue.append(paths);
+    scheduleDelivery();
+}
+
+void ImageLoader::retry(const QString &path)
+{
+    if (m_aborted) {
+        return;
+    }
+
+    m_finished = false;
+    m_queue.prepend(path);
+    scheduleDelivery();
+}
+
+void ImageLoader::setPaused(bool state)
+{
+    m_paused = state;
+    if (! m_paused) {
+        scheduleDelivery();
+    }
+}
+
+void ImageLoader::abort()
+{
+    // Images that are currently loaded will be discarded when they are finished
+    m_aborted = true;
+    m_queue.clear();
+    m_results.clear();
+    scheduleDelivery();
+}
+
+bool ImageLoader::isFinished() const
+{
+    return m_queue.isEmpty() && m_runningJobs == 0 && m_results.isEmpty();
+}
+
+void ImageLoader::scheduleDelivery()
+{
+    // We always deliver results via the event loop, so that the receiver never has to cope with a
+    // signal emitted from inside one of its own calls to us
+    if (! m_deliveryScheduled) {
+        m_deliveryScheduled = true;
+        QMetaObject::invokeMethod(this, &ImageLoader::deliverResults, Qt::QueuedConnection);
+    }
+}
+
+void ImageLoader::deliverResults()
+{
+    m_deliveryScheduled = false;
+
+    while (! m_paused && ! m_results.isEmpty()) {
+        const auto [ path, image ] = m_results.takeFirst();
+        Q_EMIT imageLoaded(path, image);
+    }
+
+    startJobs();
+
+    if (! m_finished && isFinished()) {
+        m_finished = true;
+        Q_EMIT finished();
+    }
+}
+
+void ImageLoader::startJobs()
+{
+    // Loaded images that have not been delivered yet count as running jobs, so that we never
+    // hold more than m_maximumJobs decoded images at once
+    while (! m_paused && ! m_aborted && ! m_queue.isEmpty()
+           && m_runningJobs + m_results.count() < m_maximumJobs) {
+
+        const auto path = m_queue.takeFirst();
+        m_runningJobs++;
+
+        auto *watcher = new QFutureWatcher<ImagesModel::LoadedImage>(this);
+        connect(watcher, &QFutureWatcherBase::finished,
+                this, [this, watcher, path]
+                {
+                    m_runningJobs--;
+                    if (! m_aborted) {
+                        m_results.append(qMakePair(path, watcher->result()));
+                    }
+                    watcher->deleteLater();
+                    scheduleDelivery();
+                });
+
+        const auto *imagesModel = m_imagesModel;
+        watcher->setFuture(QtConcurrent::run([imagesModel, path]
+                                             {
+                                                 return imagesModel->loadImage(path);
+                                             }));
+    }
+}
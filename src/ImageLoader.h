@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+// Local includes
+#include "ImagesModel.h"
+
+// Qt includes
+#include <QObject>
+#include <QList>
+#include <QPair>
+
+// Loads images via ImagesModel::loadImage on the global thread pool and delivers the results in
+// the order they are finished. Each job reads the metadata, decodes and scales one image. We don't
+// split this up into separate stages: they have to be done one after another for each image anyway,
+// a pool of per-image jobs keeps all cores busy just as well, and images with a cached thumbnail
+// can skip decoding and scaling altogether. The number of jobs (and thus of decoded images kept in
+// memory) is limited.
+class ImageLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ImageLoader(QObject *parent, const ImagesModel *imagesModel);
+    void load(const QList<QString> &paths);
+    void retry(const QString &path);
+    void setPaused(bool state);
+    void abort();
+    bool isFinished() const;
+
+Q_SIGNALS:
+    void imageLoaded(const QString &path, const ImagesModel::LoadedImage &image);
+    void finished();
+
+private Q_SLOTS:
+    void deliverResults();
+
+private: // Functions
+    void scheduleDelivery();
+    void startJobs();
+
+private: // Variables
+    const ImagesModel *m_imagesModel;
+
+    // The number of images being loaded at the same time. This also limits the number of decoded
+    // images kept in memory until they are passed to the model.
+    int m_maximumJobs;
+
+    QList<QString> m_queue;
+    QList<QPair<QString, ImagesModel::LoadedImage>> m_results;
+    int m_runningJobs = 0;
+    bool m_paused = false;
+    bool m_aborted = false;
+    bool m_deliveryScheduled = false;
+    bool m_finished = true;
+
+};
+
+#endif // IMAGELOADER_H
@@ -13,13 +13,95 @@
 
 // Qt includes
 #include <QDebug>
+#include <QGuiApplication>
+#include <QPalette>
+#include <QFontMetricsF>
+#include <QtMath>
+
+// C++ includes
+#include <cmath>
+#include <algorithm>
 
 static QStringList s_renderPosition { QStringLiteral("HOVERS_ABOVE_SURFACE") };
 
+// The size of the grid cells the images are sorted into, in degrees
+static const double s_cellSize = 0.25;
+static const int s_columns = int(360.0 / s_cellSize);
+static const int s_rows = int(180.0 / s_cellSize);
+
+// We don't cluster images anymore if the map is zoomed in this far
+static const int s_maximumClusterLevel = 24;
+
+// The maximum latitude that can be displayed using the Mercator projection
+static const double s_maximumMercatorLat = 85.05112878;
+
+static int cellColumn(double lon)
+{
+    return std::clamp(int(std::floor((lon + 180.0) / s_cellSize)), 0, s_columns - 1);
+}
+
+static int cellRow(double lat)
+{
+    return std::clamp(int(std::floor((lat + 90.0) / s_cellSize)), 0, s_rows - 1);
+}
+
+// The position of the given coordinates on the Mercator projected world map, scaled to [0, 1]
+static double mercatorX(double lon)
+{
+    return std::clamp((lon + 180.0) / 360.0, 0.0, 1.0);
+}
+
+static double mercatorY(double lat)
+{
+    const double radians = qDegreesToRadians(std::clamp(lat, -s_maximumMercatorLat,
+                                                        s_maximumMercatorLat));
+    return std::clamp(0.5 - std::log(std::tan(M_PI / 4.0 + radians / 2.0)) / (2.0 * M_PI),
+                      0.0, 1.0);
+}
+
+// The cell of a zoom level's clustering grid. The level's grid has 2^level cells in each direction.
+static quint32 clusterCell(double position, int level)
+{
+    const quint32 cells = quint32(1) << level;
+    return std::min(quint32(position * cells), cells - 1);
+}
+
+static quint64 clusterKey(quint32 column, quint32 row)
+{
+    return (quint64(row) << 32) | column;
+}
+
 ImagesLayer::ImagesLayer(QObject *parent, ImagesModel *model)
     : QObject(parent),
       m_imagesModel(model)
 {
+    connect(m_imagesModel, &QAbstractItemModel::dataChanged,
+            this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight)
+            {
+                updateImages(topLeft.isValid() ? topLeft.row() : 0,
+                             bottomRight.isValid() ? bottomRight.row()
+                                                   : m_imagesModel->rowCount() - 1);
+            });
+    connect(m_imagesModel, &QAbstractItemModel::rowsInserted,
+            this, [this](const QModelIndex &, int first, int last)
+            {
+                updateImages(first, last);
+            });
+    connect(m_imagesModel, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, [this](const QModelIndex &, int first, int last)
+            {
+                removeImages(first, last);
+            });
+    connect(m_imagesModel, &QAbstractItemModel::modelReset, this, &ImagesLayer::rebuild);
+
+    // Moved rows don't need any processing, as we don't use rows but paths
+
+    rebuild();
+}
+
+void ImagesLayer::setClusterImages(bool state)
+{
+    m_clusterImages = state;
 }
 
 QStringList ImagesLayer::renderPosition() const
@@ -27,28 +109,276 @@ QStringList ImagesLayer::renderPosition() const
     return s_renderPosition;
 }
 
-bool ImagesLayer::render(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
-                         const QString &, Marble::GeoSceneLayer *)
+void ImagesLayer::rebuild()
 {
-    const auto viewportCoordinates = viewport->viewLatLonAltBox();
+    m_images.clear();
+    m_cells.clear();
+    m_clusters.clear();
+    updateImages(0, m_imagesModel->rowCount() - 1);
+}
 
-    for (int row = 0; row < m_imagesModel->rowCount(); row++) {
+void ImagesLayer::updateImages(int firstRow, int lastRow)
+{
+    m_clusters.clear();
+
+    for (int row = firstRow; row <= lastRow; row++) {
         const auto index = m_imagesModel->index(row, 0);
+        const auto path = index.data(KGeoTag::PathRole).toString();
         const auto coordinates = index.data(KGeoTag::CoordinatesRole).value<Coordinates>();
+
+        removeImage(path);
         if (! coordinates.isSet()) {
             continue;
         }
 
-        const auto marbleCoordinates = Marble::GeoDataCoordinates(
-            coordinates.lon(), coordinates.lat(), coordinates.alt(),
-            Marble::GeoDataCoordinates::Degree);
+        const auto thumbnail = index.data(KGeoTag::ThumbnailRole).value<QPixmap>();
+        m_clusterSize = std::max({ m_clusterSize, thumbnail.width(), thumbnail.height() });
 
-        if (! viewportCoordinates.contains(marbleCoordinates)) {
-            continue;
+        const int cell = cellRow(coordinates.lat()) * s_columns + cellColumn(coordinates.lon());
+        m_images.insert(path, { Marble::GeoDataCoordinates(coordinates.lon(), coordinates.lat(),
+                                                           coordinates.alt(),
+                                                           Marble::GeoDataCoordinates::Degree),
+                                thumbnail,
+                                cell });
+        m_cells[cell].insert(path);
+    }
+}
+
+void ImagesLayer::removeImages(int firstRow, int lastRow)
+{
+    for (int row = firstRow; row <= lastRow; row++) {
+        removeImage(m_imagesModel->index(row, 0).data(KGeoTag::PathRole).toString());
+    }
+}
+
+void ImagesLayer::removeImage(const QString &path)
+{
+    const auto image = m_images.constFind(path);
+    if (image == m_images.constEnd()) {
+        return;
+    }
+
+    auto cell = m_cells.find(image->cell);
+    cell->remove(path);
+    if (cell->isEmpty()) {
+        m_cells.erase(cell);
+    }
+
+    m_images.erase(image);
+    m_clusters.clear();
+}
+
+QList<int> ImagesLayer::visibleCells(const Marble::GeoDataLatLonAltBox &viewportBox) const
+{
+    const int firstRow = cellRow(viewportBox.south(Marble::GeoDataCoordinates::Degree));
+    const int lastRow = cellRow(viewportBox.north(Marble::GeoDataCoordinates::Degree));
+
+    // If the viewport crosses the date line, we have two ranges of columns
+    QList<QPair<int, int>> columns;
+    const int west = cellColumn(viewportBox.west(Marble::GeoDataCoordinates::Degree));
+    const int east = cellColumn(viewportBox.east(Marble::GeoDataCoordinates::Degree));
+    if (viewportBox.crossesDateLine()) {
+        columns = { { west, s_columns - 1 }, { 0, east } };
+    } else {
+        columns = { { west, east } };
+    }
+
+    qint64 count = 0;
+    for (const auto &[ first, last ] : std::as_const(columns)) {
+        count += qint64(last - first + 1) * (lastRow - firstRow + 1);
+    }
+
+    QList<int> cells;
+
+    if (count > m_cells.count()) {
+        // The viewport covers more cells than there are occupied ones. It's faster to check all
+        // occupied cells than to look up all covered ones.
+        for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); it++) {
+            const int row = it.key() / s_columns;
+            const int column = it.key() % s_columns;
+            if (row < firstRow || row > lastRow) {
+                continue;
+            }
+            for (const auto &[ first, last ] : std::as_const(columns)) {
+                if (column >= first && column <= last) {
+                    cells.append(it.key());
+                    break;
+                }
+            }
         }
 
-        painter->drawPixmap(marbleCoordinates, index.data(KGeoTag::ThumbnailRole).value<QPixmap>());
+    } else {
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (const auto &[ first, last ] : std::as_const(columns)) {
+                for (int column = first; column <= last; column++) {
+                    const int cell = row * s_columns + column;
+                    if (m_cells.contains(cell)) {
+                        cells.append(cell);
+                    }
+                }
+            }
+        }
+    }
+
+    return cells;
+}
+
+bool ImagesLayer::render(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
+                         const QString &, Marble::GeoSceneLayer *)
+{
+    if (m_clusterImages) {
+        renderClusters(painter, viewport);
+    } else {
+        renderImages(painter, viewport->viewLatLonAltBox());
     }
 
     return true;
 }
+
+void ImagesLayer::renderImages(Marble::GeoPainter *painter,
+                               const Marble::GeoDataLatLonAltBox &viewportBox) const
+{
+    const auto cells = visibleCells(viewportBox);
+    for (const int cell : cells) {
+        for (const auto &path : m_cells.value(cell)) {
+            const auto &image = *m_images.constFind(path);
+            if (! viewportBox.contains(image.coordinates)) {
+                continue;
+            }
+            painter->drawPixmap(image.coordinates, image.thumbnail);
+        }
+    }
+}
+
+const ImagesLayer::Clusters &ImagesLayer::clusters(int level)
+{
+    auto levelClusters = m_clusters.find(level);
+    if (levelClusters != m_clusters.end()) {
+        return *levelClusters;
+    }
+
+    // Sort all images into the level's grid. The clusters are only calculated once for each
+    // displayed zoom level, until the images are changed again.
+
+    Clusters clusters;
+    for (auto it = m_images.constBegin(); it != m_images.constEnd(); it++) {
+        const double lon = it->coordinates.longitude(Marble::GeoDataCoordinates::Degree);
+        const double lat = it->coordinates.latitude(Marble::GeoDataCoordinates::Degree);
+        auto &cluster = clusters[clusterKey(clusterCell(mercatorX(lon), level),
+                                            clusterCell(mercatorY(lat), level))];
+        cluster.count++;
+        // Use the same image each time the clusters are calculated
+        if (cluster.representative.isEmpty() || it.key() < cluster.representative) {
+            cluster.representative = it.key();
+        }
+    }
+
+    return *m_clusters.insert(level, clusters);
+}
+
+void ImagesLayer::renderClusters(Marble::GeoPainter *painter, Marble::ViewportParams *viewport)
+{
+    // Choose the zoom level so that a grid cell has about the size of a thumbnail. This way, the
+    // number of clusters drawn is limited by the map's size, not by the number of images.
+    const double worldSize = 2.0 * M_PI * viewport->radius();
+    const int level = std::clamp(int(std::floor(std::log2(worldSize / m_clusterSize))),
+                                 0, s_maximumClusterLevel);
+
+    if (level == s_maximumClusterLevel) {
+        renderImages(painter, viewport->viewLatLonAltBox());
+        return;
+    }
+
+    const auto &levelClusters = clusters(level);
+    const auto viewportBox = viewport->viewLatLonAltBox();
+
+    // The clusters are culled by the extent of their cells, not by the position of their
+    // representative. Otherwise, a cluster with images inside the viewport would not be drawn if
+    // its representative is outside. A representative slightly outside the viewport is still
+    // drawn partially, as the cells have about the size of a thumbnail.
+    const auto drawCluster = [&](const Cluster &cluster)
+    {
+        const auto &image = *m_images.constFind(cluster.representative);
+        painter->drawPixmap(image.coordinates, image.thumbnail);
+        if (cluster.count > 1) {
+            drawBadge(painter, viewport, image, cluster.count);
+        }
+    };
+
+    const auto west = clusterCell(mercatorX(viewportBox.west(Marble::GeoDataCoordinates::Degree)),
+                                  level);
+    const auto east = clusterCell(mercatorX(viewportBox.east(Marble::GeoDataCoordinates::Degree)),
+                                  level);
+    const auto north = clusterCell(
+        mercatorY(viewportBox.north(Marble::GeoDataCoordinates::Degree)), level);
+    const auto south = clusterCell(
+        mercatorY(viewportBox.south(Marble::GeoDataCoordinates::Degree)), level);
+
+    const bool crossesDateLine = viewportBox.crossesDateLine();
+    const qint64 columns = crossesDateLine ? qint64((quint32(1) << level) - west + east + 1)
+                                           : qint64(east - west + 1);
+
+    // Check all clusters if there are less of them than cells covering the viewport
+    if (columns * qint64(south - north + 1) > levelClusters.count()) {
+        for (auto it = levelClusters.constBegin(); it != levelClusters.constEnd(); it++) {
+            const auto column = quint32(it.key());
+            const auto row = quint32(it.key() >> 32);
+            if (row < north || row > south) {
+                continue;
+            }
+            if (crossesDateLine ? (column < west && column > east)
+                                : (column < west || column > east)) {
+                continue;
+            }
+            drawCluster(*it);
+        }
+        return;
+    }
+
+    // Otherwise, look up the cells covering the viewport. If the viewport crosses the date line,
+    // the columns wrap around.
+    const quint32 lastColumn = crossesDateLine ? east + (quint32(1) << level) : east;
+
+    for (auto row = north; row <= south; row++) {
+        for (auto column = west; column <= lastColumn; column++) {
+            const auto cluster = levelClusters.constFind(
+                clusterKey(column & ((quint32(1) << level) - 1), row));
+            if (cluster != levelClusters.constEnd()) {
+                drawCluster(*cluster);
+            }
+        }
+    }
+}
+
+void ImagesLayer::drawBadge(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
+                            const Image &image, int count) const
+{
+    qreal x;
+    qreal y;
+    if (! viewport->screenCoordinates(image.coordinates, x, y)) {
+        return;
+    }
+
+    // GeoPainter hides QPainter's functions using screen coordinates
+    QPainter *screenPainter = painter;
+    screenPainter->save();
+
+    const auto text = QString::number(count);
+    const QFontMetricsF metrics(screenPainter->font());
+    const double height = metrics.height() + 2.0;
+    const double width = std::max(height, metrics.horizontalAdvance(text) + height / 2.0);
+
+    // Draw the badge at the thumbnail's upper right corner
+    const QRectF badge(x + image.thumbnail.width() / 2.0 - width / 2.0,
+                       y - image.thumbnail.height() / 2.0 - height / 2.0,
+                       width, height);
+
+    const auto palette = QGuiApplication::palette();
+    screenPainter->setPen(Qt::NoPen);
+    screenPainter->setBrush(palette.color(QPalette::Highlight));
+    screenPainter->drawRoundedRect(badge, height / 2.0, height / 2.0);
+    screenPainter->setPen(palette.color(QPalette::HighlightedText));
+    screenPainter->drawText(badge, Qt::AlignCenter, text);
+
+    screenPainter->restore();
+}
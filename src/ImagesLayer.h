@@ -7,9 +7,13 @@
 
 // Marble includes
 #include <marble/LayerInterface.h>
+#include <marble/GeoDataCoordinates.h>
 
 // Qt includes
 #include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QPixmap>
 
 // Local classes
 class ImagesModel;
@@ -20,6 +24,7 @@ namespace Marble
 class GeoPainter;
 class ViewportParams;
 class GeoSceneLayer;
+class GeoDataLatLonAltBox;
 }
 
 class ImagesLayer : public QObject, public Marble::LayerInterface
@@ -28,13 +33,55 @@ class ImagesLayer : public QObject, public Marble::LayerInterface
 
 public:
     ImagesLayer(QObject *parent, ImagesModel *model);
+    void setClusterImages(bool state);
     QStringList renderPosition() const override;
     bool render(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
                 const QString &, Marble::GeoSceneLayer *) override;
 
+private: // Structs
+    struct Image
+    {
+        Marble::GeoDataCoordinates coordinates;
+        QPixmap thumbnail;
+        int cell;
+    };
+
+    // All images inside one cell of a zoom level's clustering grid
+    struct Cluster
+    {
+        QString representative;
+        int count = 0;
+    };
+
+    typedef QHash<quint64, Cluster> Clusters;
+
+private: // Functions
+    void rebuild();
+    void updateImages(int firstRow, int lastRow);
+    void removeImages(int firstRow, int lastRow);
+    void removeImage(const QString &path);
+    QList<int> visibleCells(const Marble::GeoDataLatLonAltBox &viewportBox) const;
+    void renderImages(Marble::GeoPainter *painter,
+                      const Marble::GeoDataLatLonAltBox &viewportBox) const;
+    void renderClusters(Marble::GeoPainter *painter, Marble::ViewportParams *viewport);
+    const Clusters &clusters(int level);
+    void drawBadge(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
+                   const Image &image, int count) const;
+
 private: // Variables
     ImagesModel *m_imagesModel;
 
+    // All images with coordinates, and the paths of the images inside each grid cell, so that we
+    // only have to look at the images near the viewport when rendering
+    QHash<QString, Image> m_images;
+    QHash<int, QSet<QString>> m_cells;
+
+    bool m_clusterImages = false;
+    // The size of the clusters, i.e. of the largest thumbnail
+    int m_clusterSize = 1;
+    // The clusters of each zoom level displayed since the images have been changed the last time
+    QHash<int, Clusters> m_clusters;
+
 };
 
 #endif // IMAGESLAYER_H
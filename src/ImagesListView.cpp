@@ -28,10 +28,14 @@
 #include <algorithm>
 #include <functional>
 
+// The number of images before and after the current one to load the preview for in advance
+static const int s_prefetchedPreviews = 2;
+
 ImagesListView::ImagesListView(KGeoTag::ImagesListType type, SharedObjects *sharedObjects,
                                QWidget *parent)
     : QListView(parent),
       m_listType(type),
+      m_imagesModel(sharedObjects->imagesModel()),
       m_bookmarks(sharedObjects->bookmarks()),
       m_coordinatesParser(sharedObjects->coordinatesParser())
 {
@@ -40,7 +44,7 @@ ImagesListView::ImagesListView(KGeoTag::ImagesListType type, SharedObjects *shar
     setDragDropMode(QAbstractItemView::DropOnly);
 
     m_listFilter = new ImagesListFilter(this, type);
-    m_listFilter->setSourceModel(sharedObjects->imagesModel());
+    m_listFilter->setSourceModel(m_imagesModel);
     setModel(m_listFilter);
     connect(m_listFilter, &ImagesListFilter::requestAddingImages,
             this, &ImagesListView::requestAddingImages);
@@ -185,7 +189,27 @@ void ImagesListView::currentChanged(const QModelIndex &current, const QModelInde
     if (current.isValid()) {
         Q_EMIT imageSelected(current);
         scrollTo(current);
+        prefetchPreviews(current);
+    }
+}
+
+void ImagesListView::prefetchPreviews(const QModelIndex &current)
+{
+    // The user will most probably browse through the list, so we prepare the neighbours' previews
+    // so that they are available instantly
+
+    QList<QString> paths;
+    const auto rowCount = m_listFilter->rowCount();
+    for (int row = current.row() - s_prefetchedPreviews;
+         row <= current.row() + s_prefetchedPreviews; row++) {
+
+        if (row < 0 || row >= rowCount || row == current.row()) {
+            continue;
+        }
+        paths.append(m_listFilter->index(row, 0).data(KGeoTag::PathRole).toString());
     }
+
+    m_imagesModel->prefetchPreviews(paths);
 }
 
 void ImagesListView::updateBookmarks()
@@ -14,6 +14,7 @@
 
 // Local classes
 class SharedObjects;
+class ImagesModel;
 class ImagesListFilter;
 class CoordinatesParser;
 
@@ -66,8 +67,12 @@ private Q_SLOTS:
     void openExternally();
     void assignToClipboard();
 
+private: // Functions
+    void prefetchPreviews(const QModelIndex &current);
+
 private: // Variables
     KGeoTag::ImagesListType m_listType;
+    ImagesModel *m_imagesModel;
     ImagesListFilter *m_listFilter;
     const QHash<QString, Coordinates> *m_bookmarks;
     CoordinatesParser *m_coordinatesParser;
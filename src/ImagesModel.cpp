@@ -6,27 +6,72 @@
 #include "ImagesModel.h"
 #include "KGeoTag.h"
 #include "Coordinates.h"
+#include "ImageCache.h"
+#include "Logging.h"
 
 // KDE includes
 #include <KLocalizedString>
 #include <KExiv2/KExiv2>
+#include <KExiv2/KExiv2Previews>
 
 // Qt includes
 #include <QFileInfo>
 #include <QFont>
+#include <QImageReader>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+#include <QSet>
 
 // C++ includes
 #include <utility>
+#include <algorithm>
+#include <cmath>
 
-ImagesModel::ImagesModel(QObject *parent, bool splitImagesList, int thumbnailSize, int previewSize)
+// Embedded previews with an aspect ratio deviating more than this from the image's one are not used
+static const double s_maximumAspectRatioDeviation = 0.02;
+
+// The memory the previews may use (in KiB) if the thumbnails already use up all of the model's
+// memory budget. We need at least a few of them for browsing through the images.
+static const int s_minimumPreviewsMemory = 32 * 1024;
+
+// If removing images would result in more non-contiguous row ranges to be removed, the model is
+// reset instead of removing each range
+static const int s_maximumRemovedRanges = 100;
+
+// A QDateTime carrying a QTimeZone keeps its data on the heap. QDateTimePrivate holds a reference
+// count, the status flags, the milliseconds since the epoch, the offset from UTC and the QTimeZone,
+// so this is its size on a 64 bit system, plus the allocator's overhead.
+static const qint64 s_dateTimePrivateSize = 32 + 16;
+
+static qint64 stringMemory(const QString &string)
+{
+    return qint64(sizeof(QString)) + string.capacity() * qint64(sizeof(QChar));
+}
+
+ImagesModel::ImagesModel(QObject *parent, bool splitImagesList, int thumbnailSize, int previewSize,
+                         bool useEmbeddedPreviews, int imageCacheSize, int memoryLimit)
     : QAbstractListModel(parent),
       m_splitImagesList(splitImagesList),
       m_thumbnailSize(QSize(thumbnailSize, thumbnailSize)),
-      m_previewSize(QSize(previewSize, previewSize))
+      m_previewSize(QSize(previewSize, previewSize)),
+      m_useEmbeddedPreviews(useEmbeddedPreviews),
+      m_memoryLimit(qint64(memoryLimit) * 1024 * 1024)
 {
+    m_imageCache = new ImageCache(this, thumbnailSize, previewSize, useEmbeddedPreviews,
+                                  imageCacheSize);
+    updatePreviewsBudget();
     m_timeZone = QTimeZone::systemTimeZone();
 }
 
+ImagesModel::~ImagesModel()
+{
+    // The preview prefetching jobs use our settings and the image cache, so we can't go away
+    // before they are done
+    for (auto &future : m_pendingPreviews) {
+        future.waitForFinished();
+    }
+}
+
 void ImagesModel::setSplitImagesList(bool state)
 {
     m_splitImagesList = state;
@@ -86,7 +131,7 @@ QVariant ImagesModel::data(const QModelIndex &index, int role) const
         return path;
 
     } else if (role == KGeoTag::DateRole) {
-        return data.date;
+        return date(path);
 
     } else if (role == KGeoTag::CoordinatesRole) {
         QVariant coordinates;
@@ -97,7 +142,7 @@ QVariant ImagesModel::data(const QModelIndex &index, int role) const
         return data.thumbnail;
 
     } else if (role == KGeoTag::PreviewRole) {
-        return data.preview;
+        return preview(path);
 
     } else if (role == KGeoTag::MatchTypeRole) {
         QVariant matchType;
@@ -115,51 +160,53 @@ QVariant ImagesModel::data(const QModelIndex &index, int role) const
 ImagesModel::LoadResult ImagesModel::addImage(const QString &path)
 {
     // Check if we already have the image
-    if (m_paths.contains(path)) {
+    if (m_imageData.contains(path)) {
         return LoadResult::AlreadyLoaded;
     }
 
-    // Read the image
-    QImage image = QImage(path);
-    if (image.isNull()) {
-        return LoadResult::LoadingImageFailed;
-    }
+    return addLoadedImage(path, loadImage(path));
+}
+
+ImagesModel::LoadedImage ImagesModel::loadImage(const QString &path) const
+{
+    // This only reads the file and doesn't touch the model's data, so that it can be run in
+    // another thread. The result has to be passed to addLoadedImage in the main thread.
+
+    LoadedImage image;
 
     // Read the exif data
+
     auto exif = KExiv2Iface::KExiv2();
     exif.setUseXMPSidecar4Reading(true);
     if (! exif.load(path)) {
-        return LoadResult::LoadingMetadataFailed;
+        // Only report a metadata problem if the file is actually a readable image
+        image.result = QImageReader(path).canRead() ? LoadResult::LoadingMetadataFailed
+                                                    : LoadResult::LoadingImageFailed;
+        return image;
     }
 
-    // Prepare the images's data struct
-    ImageData data;
-
     // Add the filename
     const QFileInfo info(path);
-    data.fileName = info.fileName();
+    image.fileName = info.fileName();
 
     // Read the date
-    data.date = exif.getImageDateTime();
+    image.date = exif.getImageDateTime();
 
     // If no date could be read from the metadata, fall back to file properties
-    if (! data.date.isValid()) {
+    if (! image.date.isValid()) {
         // First try to get the file's initial creation date
-        data.date = info.birthTime();
+        image.date = info.birthTime();
 
         // If that fails, fall back to the file's mtime
-        if (! data.date.isValid()) {
-            data.date = info.lastModified();
+        if (! image.date.isValid()) {
+            image.date = info.lastModified();
         }
     }
 
-    // Apply the currently set timezone
-    data.date.setTimeZone(m_timeZone);
-
     // Strip out milliseconds if the image provides them to allow seconds-exact matching
-    const auto msec = data.date.time().msec();
+    const auto msec = image.date.time().msec();
     if (msec != 0) {
-        data.date = data.date.addMSecs(msec * -1);
+        image.date = image.date.addMSecs(msec * -1);
     }
 
     // Try to read gps information
@@ -167,41 +214,366 @@ ImagesModel::LoadResult ImagesModel::addImage(const QString &path)
     double latitude;
     double longitude;
     if (exif.getGPSInfo(altitude, latitude, longitude)) {
-        data.originalCoordinates = Coordinates(longitude, latitude, altitude, true);
-        data.lastSavedCoordinates = data.originalCoordinates;
-        data.coordinates = data.originalCoordinates;
+        image.coordinates = Coordinates(longitude, latitude, altitude, true);
+    }
+
+    // If we already processed this image in an earlier session, we can skip decoding it. The
+    // preview will be read from the cache when it's needed.
+    image.thumbnail = m_imageCache->thumbnail(path);
+    if (! image.thumbnail.isNull()) {
+        image.result = LoadResult::LoadingSucceeded;
+        return image;
+    }
+
+    // Decode the image
+    const auto decodedImage = decodeImage(path, exif);
+    if (decodedImage.isNull()) {
+        image.result = LoadResult::LoadingImageFailed;
+        return image;
+    }
+
+    // We create the preview anyway, so we pass it on so that it can be kept for a while
+    scaleImage(decodedImage, image.thumbnail, image.preview);
+    m_imageCache->store(path, image.thumbnail, image.preview);
+
+    image.result = LoadResult::LoadingSucceeded;
+    return image;
+}
+
+QImage ImagesModel::loadPreview(const QString &path) const
+{
+    // Like loadImage, this can be run in another thread
+
+    auto preview = m_imageCache->preview(path);
+    if (! preview.isNull()) {
+        return preview;
+    }
+
+    // We need the exif data for the image's orientation
+    auto exif = KExiv2Iface::KExiv2();
+    exif.setUseXMPSidecar4Reading(true);
+    exif.load(path);
+
+    const auto decodedImage = decodeImage(path, exif);
+    if (decodedImage.isNull()) {
+        return QImage();
+    }
+
+    QImage thumbnail;
+    scaleImage(decodedImage, thumbnail, preview);
+    m_imageCache->store(path, thumbnail, preview);
+
+    return preview;
+}
+
+QImage ImagesModel::decodeImage(const QString &path, const KExiv2Iface::KExiv2 &exif) const
+{
+    // Camera JPEGs and RAW images often carry an embedded preview that is big enough for what we
+    // need, so that we can skip decoding the whole image
+    QImage decodedImage;
+    if (m_useEmbeddedPreviews) {
+        decodedImage = embeddedPreview(path);
+    }
+
+    if (decodedImage.isNull()) {
+        decodedImage = decodeScaled(path);
+        if (decodedImage.isNull()) {
+            return decodedImage;
+        }
     }
 
     // Fix the image's orientation
-    exif.rotateExifQImage(image, exif.getImageOrientation());
+    exif.rotateExifQImage(decodedImage, exif.getImageOrientation());
 
-    // Create a smaller thumbnail
-    data.thumbnail = QPixmap::fromImage(image.scaled(m_thumbnailSize, Qt::KeepAspectRatio,
-                                                     Qt::SmoothTransformation));
+    return decodedImage;
+}
 
-    // Create a bigger preview (to be scaled according to the view size)
-    data.preview = image.scaled(m_previewSize, Qt::KeepAspectRatio);
+void ImagesModel::scaleImage(const QImage &decodedImage, QImage &thumbnail, QImage &preview) const
+{
+    // Create a bigger preview (to be scaled according to the view size). The decoded image is
+    // already about this size, so we can afford a smooth transformation here.
+    preview = decodedImage.scaled(m_previewSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    // Create a smaller thumbnail. We derive it from the preview if that one is big enough, so that
+    // only a small image has to be scaled down.
+    const auto &thumbnailSource = m_previewSize.width() >= m_thumbnailSize.width()
+        ? preview : decodedImage;
+    thumbnail = thumbnailSource.scaled(m_thumbnailSize, Qt::KeepAspectRatio,
+                                       Qt::SmoothTransformation);
+}
+
+QImage ImagesModel::embeddedPreview(const QString &path) const
+{
+    KExiv2Iface::KExiv2Previews previews(path);
+    if (previews.isEmpty()) {
+        return QImage();
+    }
+
+    // We need both the thumbnail and the preview to be scaled down from the embedded preview
+    const int requiredSize = std::max(m_thumbnailSize.width(), m_previewSize.width());
+    const auto originalSize = previews.originalSize();
 
-    // Find the correct row for the new image (sorted by date)
-    int row = 0;
-    for (const QString &path : m_paths) {
-        if (m_imageData.value(path).date > data.date) {
-            break;
+    int bestIndex = -1;
+    int bestArea = 0;
+
+    for (int i = 0; i < previews.count(); i++) {
+        const int width = previews.width(i);
+        const int height = previews.height(i);
+
+        if (std::max(width, height) < requiredSize || height == 0) {
+            continue;
+        }
+
+        // Skip previews with a different aspect ratio (e.g. with black borders added)
+        if (originalSize.isValid() && originalSize.height() != 0
+            && std::abs(double(width) / double(height)
+                        - double(originalSize.width()) / double(originalSize.height()))
+               > s_maximumAspectRatioDeviation) {
+
+            continue;
+        }
+
+        // Use the smallest preview that is big enough
+        if (bestIndex == -1 || width * height < bestArea) {
+            bestIndex = i;
+            bestArea = width * height;
         }
-        row++;
     }
 
-    // Add the image
+    if (bestIndex == -1) {
+        return QImage();
+    }
 
-    beginInsertRows(QModelIndex(), row, row);
-    m_paths.insert(row, path);
-    m_imageData.insert(path, data);
-    endInsertRows();
+    return previews.image(bestIndex);
+}
 
-    const auto modelIndex = index(row, 0);
-    Q_EMIT dataChanged(modelIndex, modelIndex, { Qt::DisplayRole });
+QImage ImagesModel::decodeScaled(const QString &path) const
+{
+    QImageReader reader(path);
+
+    // We neither need the full resolution for the preview nor for the thumbnail. If the image
+    // format supports it (e.g. JPEG, which can scale by 1/2, 1/4 or 1/8 while decoding), we let
+    // the reader only decode what we actually need. Otherwise, this is still done by the reader
+    // and the full-size image is never handed out. As both target sizes are squares, the image's
+    // orientation doesn't matter here.
+    const int requiredSize = std::max(m_thumbnailSize.width(), m_previewSize.width());
+    const auto originalSize = reader.size();
+    if (originalSize.isValid()
+        && std::max(originalSize.width(), originalSize.height()) > requiredSize) {
+
+        reader.setScaledSize(originalSize.scaled(requiredSize, requiredSize, Qt::KeepAspectRatio));
+    }
+
+    return reader.read();
+}
+
+ImagesModel::LoadResult ImagesModel::addLoadedImage(const QString &path, const LoadedImage &image)
+{
+    if (image.result != LoadResult::LoadingSucceeded) {
+        return image.result;
+    }
+
+    return addLoadedImages({ qMakePair(path, image) }) == 1 ? LoadResult::LoadingSucceeded
+                                                             : LoadResult::AlreadyLoaded;
+}
+
+int ImagesModel::addLoadedImages(const QList<QPair<QString, LoadedImage>> &images)
+{
+    // Prepare the images' data structs
+
+    QList<QPair<QString, ImageData>> newImages;
+    newImages.reserve(images.count());
+    QSet<QString> newPaths;
+
+    for (const auto &[ path, image ] : images) {
+        // Skip images that failed to load and images we already have
+        if (image.result != LoadResult::LoadingSucceeded || m_imageData.contains(path)
+            || newPaths.contains(path)) {
+
+            continue;
+        }
+        newPaths.insert(path);
+
+        ImageData data;
+        data.fileName = image.fileName;
+        data.date = image.date;
+        data.originalCoordinates = image.coordinates;
+        data.lastSavedCoordinates = image.coordinates;
+        data.coordinates = image.coordinates;
+        data.thumbnail = QPixmap::fromImage(image.thumbnail);
+
+        // Apply the currently set timezone
+        data.date.setTimeZone(m_timeZone);
+
+        m_thumbnailsMemory += thumbnailMemory(data);
+        m_metadataMemory += metadataMemory(path, data);
+        m_datesMemory += dateMemory(data);
+
+        if (! image.preview.isNull()) {
+            cachePreview(path, image.preview);
+        }
+
+        newImages.append(qMakePair(path, data));
+    }
+
+    if (newImages.isEmpty()) {
+        return 0;
+    }
+
+    // Sort the new images by date. The ones we already have are sorted already.
+    std::stable_sort(newImages.begin(), newImages.end(),
+                     [](const auto &image1, const auto &image2)
+                     {
+                         return image1.second.date < image2.second.date;
+                     });
+
+    const int oldCount = m_paths.count();
+    const int count = newImages.count();
+    const int firstRow = rowFor(newImages.first().second.date);
+
+    if (firstRow == rowFor(newImages.last().second.date)) {
+        // All new images belong between the same two existing ones (e.g. they are all newer than
+        // the ones we already have), so we can insert them in one go
+
+        QList<QString> paths;
+        paths.reserve(oldCount + count);
+        paths.append(m_paths.mid(0, firstRow));
+        for (const auto &image : std::as_const(newImages)) {
+            paths.append(image.first);
+        }
+        paths.append(m_paths.mid(firstRow));
+
+        beginInsertRows(QModelIndex(), firstRow, firstRow + count - 1);
+        m_paths = paths;
+        for (const auto &[ path, data ] : std::as_const(newImages)) {
+            m_imageData.insert(path, data);
+        }
+        updateRows(firstRow);
+        endInsertRows();
+
+    } else {
+        // The new images are scattered over the list. We append them first and then move all
+        // rows to their correct position with one layout change.
 
-    return LoadResult::LoadingSucceeded;
+        beginInsertRows(QModelIndex(), oldCount, oldCount + count - 1);
+        for (const auto &[ path, data ] : std::as_const(newImages)) {
+            m_paths.append(path);
+            m_imageData.insert(path, data);
+        }
+        updateRows(oldCount);
+        endInsertRows();
+
+        Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+        // Merge the existing and the new rows in one pass. For images with the same date, the
+        // existing ones come first.
+
+        const auto dateAt = [this](int row)
+        {
+            return m_imageData.constFind(m_paths.at(row))->date;
+        };
+
+        QList<QString> paths;
+        paths.reserve(oldCount + count);
+        QList<int> newRows(oldCount + count);
+        int existing = 0;
+        int added = oldCount;
+
+        while (existing < oldCount || added < oldCount + count) {
+            const bool takeExisting = added == oldCount + count
+                                      || (existing < oldCount
+                                          && dateAt(existing) <= dateAt(added));
+            const int row = takeExisting ? existing++ : added++;
+            newRows[row] = paths.count();
+            paths.append(m_paths.at(row));
+        }
+
+        const auto oldIndexes = persistentIndexList();
+        QModelIndexList newIndexes;
+        newIndexes.reserve(oldIndexes.count());
+        for (const auto &oldIndex : oldIndexes) {
+            newIndexes.append(index(newRows.at(oldIndex.row()), oldIndex.column()));
+        }
+        changePersistentIndexList(oldIndexes, newIndexes);
+
+        m_paths = paths;
+        updateRows(0);
+
+        Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    }
+
+    updatePreviewsBudget();
+
+    return count;
+}
+
+void ImagesModel::updateRows(int firstRow)
+{
+    for (int row = firstRow; row < m_paths.count(); row++) {
+        m_rows.insert(m_paths.at(row), row);
+    }
+}
+
+int ImagesModel::rowFor(const QDateTime &dateTime) const
+{
+    // Find the row a new image with the given date has to be inserted at: after all images that
+    // are not newer than it
+    const auto position = std::upper_bound(m_paths.constBegin(), m_paths.constEnd(), dateTime,
+        [this](const QDateTime &newDate, const QString &path)
+        {
+            return newDate < m_imageData.constFind(path)->date;
+        });
+    return position - m_paths.constBegin();
+}
+
+QImage ImagesModel::preview(const QString &path) const
+{
+    if (const auto *cachedPreview = m_previews.object(path)) {
+        return *cachedPreview;
+    }
+
+    // We don't have this preview (anymore), so we have to load it now
+    const auto loadedPreview = loadPreview(path);
+    if (! loadedPreview.isNull()) {
+        cachePreview(path, loadedPreview);
+    }
+    return loadedPreview;
+}
+
+void ImagesModel::cachePreview(const QString &path, const QImage &preview) const
+{
+    m_previews.insert(path, new QImage(preview), std::max(int(preview.sizeInBytes() / 1024), 1));
+}
+
+void ImagesModel::prefetchPreviews(const QList<QString> &paths)
+{
+    for (const auto &path : paths) {
+        if (! m_imageData.contains(path) || m_previews.contains(path)
+            || m_pendingPreviews.contains(path)) {
+
+            continue;
+        }
+
+        auto *watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcherBase::finished,
+                this, [this, watcher, path]
+                {
+                    m_pendingPreviews.remove(path);
+                    const auto preview = watcher->result();
+                    // The image could have been removed in the meantime
+                    if (! preview.isNull() && m_imageData.contains(path)) {
+                        cachePreview(path, preview);
+                    }
+                    watcher->deleteLater();
+                });
+
+        const auto future = QtConcurrent::run([this, path]
+                                              {
+                                                  return loadPreview(path);
+                                              });
+        m_pendingPreviews.insert(path, future);
+        watcher->setFuture(future);
+    }
 }
 
 void ImagesModel::emitDataChanged(const QString &path)
@@ -253,12 +625,16 @@ QList<QString> ImagesModel::imagesLoadedTagged() const
 
 QDateTime ImagesModel::date(const QString &path) const
 {
-    return m_imageData.value(path).date;
+    const auto &data = m_imageData.value(path);
+    if (! data.timeZone.isValid()) {
+        return data.date;
+    }
+    return QDateTime(data.date.date(), data.date.time(), data.timeZone);
 }
 
 bool ImagesModel::contains(const QString &path) const
 {
-    return m_paths.contains(path);
+    return m_imageData.contains(path);
 }
 
 Coordinates ImagesModel::coordinates(const QString &path) const
@@ -293,7 +669,7 @@ void ImagesModel::resetChanges(const QString &path)
 
 QModelIndex ImagesModel::indexFor(const QString &path) const
 {
-    return index(m_paths.indexOf(path), 0);
+    return index(m_rows.value(path, -1), 0);
 }
 
 void ImagesModel::setSaved(const QString &path)
@@ -311,9 +687,63 @@ void ImagesModel::setImagesTimeZone(const QByteArray &id)
 {
     m_timeZone = QTimeZone(id);
 
+    // This also discards all images' own timezones
+    m_datesMemory = 0;
     for (const auto &path : m_paths) {
-        m_imageData[path].date.setTimeZone(m_timeZone);
+        auto &data = m_imageData[path];
+        data.date.setTimeZone(m_timeZone);
+        data.timeZone = QTimeZone();
+        m_datesMemory += dateMemory(data);
     }
+
+    updatePreviewsBudget();
+}
+
+QTimeZone ImagesModel::timeZone(const QByteArray &id)
+{
+    // Constructing a QTimeZone is expensive, so we only do this once per ID
+    auto timeZone = m_timeZones.value(id);
+    if (! timeZone.isValid()) {
+        timeZone = QTimeZone(id);
+        if (timeZone.isValid()) {
+            m_timeZones.insert(id, timeZone);
+        }
+    }
+    return timeZone;
+}
+
+QDateTime ImagesModel::date(const QString &path, const QByteArray &timeZoneId)
+{
+    const auto timeZone = this->timeZone(timeZoneId);
+    if (! m_imageData.contains(path) || ! timeZone.isValid()) {
+        return QDateTime();
+    }
+
+    const auto &date = m_imageData[path].date;
+    return QDateTime(date.date(), date.time(), timeZone);
+}
+
+bool ImagesModel::setImageTimeZone(const QString &path, const QByteArray &id)
+{
+    if (! m_imageData.contains(path)) {
+        return false;
+    }
+
+    const auto timeZone = this->timeZone(id);
+    if (! timeZone.isValid()) {
+        return false;
+    }
+
+    auto &data = m_imageData[path];
+    data.timeZone = timeZone == m_timeZone ? QTimeZone() : timeZone;
+    emitDataChanged(path);
+    return true;
+}
+
+QByteArray ImagesModel::timeZoneId(const QString &path) const
+{
+    const auto &data = m_imageData.value(path);
+    return data.timeZone.isValid() ? data.timeZone.id() : m_timeZone.id();
 }
 
 bool ImagesModel::hasPendingChanges(const QString &path) const
@@ -324,15 +754,82 @@ bool ImagesModel::hasPendingChanges(const QString &path) const
 
 void ImagesModel::removeImages(const QList<QString> &paths)
 {
+    // Collect the rows to remove
+
+    QSet<QString> removedPaths;
+    QList<int> rows;
+    rows.reserve(paths.count());
     for (const auto &path : paths) {
-        const auto row = m_paths.indexOf(path);
-        const auto modelIndex = index(row, 0);
-        beginRemoveRows(QModelIndex(), row, row);
-        m_paths.remove(row);
+        const auto row = m_rows.value(path, -1);
+        if (row == -1 || removedPaths.contains(path)) {
+            continue;
+        }
+        removedPaths.insert(path);
+        rows.append(row);
+    }
+
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    std::sort(rows.begin(), rows.end());
+
+    // Coalesce the rows to contiguous ranges
+    QList<QPair<int, int>> ranges;
+    for (const auto row : std::as_const(rows)) {
+        if (! ranges.isEmpty() && ranges.last().second == row - 1) {
+            ranges.last().second = row;
+        } else {
+            ranges.append(qMakePair(row, row));
+        }
+    }
+
+    // The images' data has to be removed before the views are notified, so that everything
+    // connected to the model sees the remaining images only
+    const auto removeData = [this](const QString &path)
+    {
+        const auto &data = m_imageData[path];
+        m_thumbnailsMemory -= thumbnailMemory(data);
+        m_metadataMemory -= metadataMemory(path, data);
+        m_datesMemory -= dateMemory(data);
         m_imageData.remove(path);
-        Q_EMIT dataChanged(modelIndex, modelIndex, { Qt::DisplayRole });
-        endRemoveRows();
+        m_rows.remove(path);
+        m_previews.remove(path);
+    };
+
+    if (ranges.count() > s_maximumRemovedRanges) {
+        // The removed images are scattered all over the list, so it's cheaper to reset the model
+        // than to announce each range
+        beginResetModel();
+        QList<QString> remainingPaths;
+        remainingPaths.reserve(m_paths.count() - rows.count());
+        for (const auto &path : std::as_const(m_paths)) {
+            if (removedPaths.contains(path)) {
+                removeData(path);
+            } else {
+                remainingPaths.append(path);
+            }
+        }
+        m_paths = remainingPaths;
+        updateRows(ranges.first().first);
+        endResetModel();
+
+    } else {
+        // Remove the ranges from the last to the first one, so that the rows of the ranges not
+        // processed yet stay valid
+        for (auto range = ranges.crbegin(); range != ranges.crend(); range++) {
+            beginRemoveRows(QModelIndex(), range->first, range->second);
+            for (int row = range->first; row <= range->second; row++) {
+                removeData(m_paths.at(row));
+            }
+            m_paths.remove(range->first, range->second - range->first + 1);
+            updateRows(range->first);
+            endRemoveRows();
+        }
     }
+
+    updatePreviewsBudget();
+    logMemoryUsage();
 }
 
 void ImagesModel::removeAllImages()
@@ -343,6 +840,67 @@ void ImagesModel::removeAllImages()
     beginRemoveRows(QModelIndex(), 0, lastRow);
     m_paths.clear();
     m_imageData.clear();
+    m_rows.clear();
+    m_previews.clear();
     Q_EMIT dataChanged(firstModelIndex, lastModelIndex, { Qt::DisplayRole });
     endRemoveRows();
+
+    m_thumbnailsMemory = 0;
+    m_metadataMemory = 0;
+    m_datesMemory = 0;
+    updatePreviewsBudget();
+    logMemoryUsage();
+}
+
+qint64 ImagesModel::thumbnailMemory(const ImageData &data)
+{
+    const auto &thumbnail = data.thumbnail;
+    return qint64(thumbnail.width()) * thumbnail.height() * thumbnail.depth() / 8;
+}
+
+qint64 ImagesModel::metadataMemory(const QString &path, const ImageData &data)
+{
+    // This is an estimation: the path is shared between m_paths and m_imageData, and the hash's
+    // internal overhead is not counted. The dates' heap data is counted by dateMemory.
+    return stringMemory(path) + stringMemory(data.fileName) + qint64(sizeof(ImageData))
+           - qint64(sizeof(QString));
+}
+
+qint64 ImagesModel::dateMemory(const ImageData &data)
+{
+    // Each date carrying a timezone has its own private data. The timezones themselves (also the
+    // one in ImageData::timeZone) are copies of the ones in m_timeZone and m_timeZones, which share
+    // their data, so they don't use additional memory per image.
+    return data.date.timeSpec() == Qt::TimeZone ? s_dateTimePrivateSize : 0;
+}
+
+void ImagesModel::updatePreviewsBudget()
+{
+    // The previews get what is left of the memory limit after the thumbnails and the metadata,
+    // which we have to keep anyway. Reducing the maximum cost evicts previews if necessary.
+    const auto available = (m_memoryLimit - m_thumbnailsMemory - m_metadataMemory
+                            - m_datesMemory) / 1024;
+    m_previews.setMaxCost(int(std::max(available, qint64(s_minimumPreviewsMemory))));
+}
+
+ImagesModel::MemoryUsage ImagesModel::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.thumbnails = m_thumbnailsMemory;
+    usage.previews = qint64(m_previews.totalCost()) * 1024;
+    usage.metadata = m_metadataMemory;
+    usage.dates = m_datesMemory;
+    return usage;
+}
+
+void ImagesModel::logMemoryUsage() const
+{
+    const auto usage = memoryUsage();
+    qCDebug(KGeoTagLog) << "Images model memory usage for" << m_paths.count() << "images:"
+                        << usage.thumbnails / 1024 << "KiB thumbnails,"
+                        << usage.previews / 1024 << "KiB previews (" << m_previews.count()
+                        << "kept),"
+                        << usage.metadata / 1024 << "KiB metadata,"
+                        << usage.dates / 1024 << "KiB dates; limit:"
+                        << m_memoryLimit / 1024 << "KiB";
 }
@@ -17,6 +17,18 @@
 #include <QImage>
 #include <QSize>
 #include <QTimeZone>
+#include <QCache>
+#include <QHash>
+#include <QFuture>
+
+// Local classes
+class ImageCache;
+
+// KDE classes
+namespace KExiv2Iface
+{
+class KExiv2;
+}
 
 class ImagesModel : public QAbstractListModel
 {
@@ -30,7 +42,30 @@ public:
         LoadingSucceeded
     };
 
-    explicit ImagesModel(QObject *parent, bool splitImagesList, int thumbnailSize, int previewSize);
+    // The data read from an image file, before it is added to the model. The preview is only set
+    // if the image had to be decoded anyway.
+    struct LoadedImage
+    {
+        LoadResult result = LoadResult::LoadingImageFailed;
+        QString fileName;
+        QDateTime date;
+        Coordinates coordinates;
+        QImage thumbnail;
+        QImage preview;
+    };
+
+    // The (estimated) memory used by the model's data, in bytes
+    struct MemoryUsage
+    {
+        qint64 thumbnails = 0;
+        qint64 previews = 0;
+        qint64 metadata = 0;
+        qint64 dates = 0;
+    };
+
+    explicit ImagesModel(QObject *parent, bool splitImagesList, int thumbnailSize, int previewSize,
+                         bool useEmbeddedPreviews, int imageCacheSize, int memoryLimit);
+    ~ImagesModel() override;
 
     int rowCount(const QModelIndex & = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
@@ -39,11 +74,18 @@ public:
     QModelIndex indexFor(const QString &path) const;
     bool contains(const QString &path) const;
     LoadResult addImage(const QString &path);
+    LoadedImage loadImage(const QString &path) const;
+    LoadResult addLoadedImage(const QString &path, const LoadedImage &image);
+    int addLoadedImages(const QList<QPair<QString, LoadedImage>> &images);
+    QImage loadPreview(const QString &path) const;
+    void prefetchPreviews(const QList<QString> &paths);
     const QList<QString> &allImages() const;
     QList<QString> imagesWithPendingChanges() const;
     QList<QString> processedSavedImages() const;
     QList<QString> imagesLoadedTagged() const;
     QDateTime date(const QString &path) const;
+    // The image's date if it was taken in the given timezone
+    QDateTime date(const QString &path, const QByteArray &timeZoneId);
     KGeoTag::MatchType matchType(const QString &path) const;
     void setCoordinates(const QString &path, const Coordinates &coordinates,
                         KGeoTag::MatchType matchType);
@@ -52,34 +94,72 @@ public:
     void resetChanges(const QString &path);
     void setSaved(const QString &path);
     void setImagesTimeZone(const QByteArray &id);
+    bool setImageTimeZone(const QString &path, const QByteArray &id);
+    QByteArray timeZoneId(const QString &path) const;
     bool hasPendingChanges(const QString &path) const;
     void removeImages(const QList<QString> &paths);
     void removeAllImages();
+    MemoryUsage memoryUsage() const;
+    void logMemoryUsage() const;
 
 private: // Functions
     void emitDataChanged(const QString &path);
+    QImage decodeImage(const QString &path, const KExiv2Iface::KExiv2 &exif) const;
+    QImage embeddedPreview(const QString &path) const;
+    QImage decodeScaled(const QString &path) const;
+    void scaleImage(const QImage &decodedImage, QImage &thumbnail, QImage &preview) const;
+    QImage preview(const QString &path) const;
+    void cachePreview(const QString &path, const QImage &preview) const;
+    void updatePreviewsBudget();
+    void updateRows(int firstRow);
+    QTimeZone timeZone(const QByteArray &id);
+    int rowFor(const QDateTime &dateTime) const;
 
 private: // Variables
     struct ImageData {
         QString fileName;
         QDateTime date;
+        // Only set if the image was taken in another timezone than the one set for all images.
+        // date is kept in the images' timezone, so that the rows' order doesn't change.
+        QTimeZone timeZone;
         Coordinates originalCoordinates;
         Coordinates lastSavedCoordinates;
         Coordinates coordinates;
         QPixmap thumbnail;
-        QImage preview;
         KGeoTag::MatchType matchType = KGeoTag::NotMatched;
         bool changed = false;
     };
 
+    static qint64 thumbnailMemory(const ImageData &data);
+    static qint64 metadataMemory(const QString &path, const ImageData &data);
+    static qint64 dateMemory(const ImageData &data);
+
     bool m_splitImagesList;
     QSize m_thumbnailSize;
     QSize m_previewSize;
+    bool m_useEmbeddedPreviews;
+    ImageCache *m_imageCache;
 
     KColorScheme m_colorScheme;
     QList<QString> m_paths;
     QHash<QString, ImageData> m_imageData;
+
+    // The row of each path in m_paths. It has to be updated each time m_paths is changed.
+    QHash<QString, int> m_rows;
     QTimeZone m_timeZone;
+    QHash<QByteArray, QTimeZone> m_timeZones;
+
+    // The recently used previews. They are created or read from the cache on demand, so that we
+    // don't have to keep all of them in memory.
+    mutable QCache<QString, QImage> m_previews;
+    // The running preview prefetching jobs
+    QHash<QString, QFuture<QImage>> m_pendingPreviews;
+
+    // In bytes. If the thumbnails and the metadata use up most of it, previews are evicted.
+    qint64 m_memoryLimit;
+    qint64 m_thumbnailsMemory = 0;
+    qint64 m_metadataMemory = 0;
+    qint64 m_datesMemory = 0;
 
 };
 
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "IsoDateTime.h"
+
+// Qt includes
+#include <QDateTime>
+
+namespace IsoDateTime
+{
+
+// Reads a number with the given count of digits at the given position
+static bool readNumber(QStringView text, int position, int digits, int *number)
+{
+    if (position + digits > text.size()) {
+        return false;
+    }
+
+    *number = 0;
+    for (int i = position; i < position + digits; i++) {
+        const auto character = text.at(i).unicode();
+        if (character < u'0' || character > u'9') {
+            return false;
+        }
+        *number = *number * 10 + (character - u'0');
+    }
+
+    return true;
+}
+
+static bool isSeparator(QStringView text, int position, char16_t separator)
+{
+    return position < text.size() && text.at(position).unicode() == separator;
+}
+
+// Returns the number of days since 1970-01-01 for the given date of the proleptic Gregorian
+// calendar (cf. Howard Hinnant's "days_from_civil" algorithm)
+static qint64 daysFromCivil(qint64 year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static int daysInMonth(int year, int month)
+{
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+        return 29;
+    }
+    return days[month - 1];
+}
+
+// Parses the fixed "YYYY-MM-DDThh:mm:ss[.fff](Z|+hh:mm|-hh:mm)" format as used by virtually all
+// GPX files, without any allocation. Returns false for everything else.
+static bool parseFixedFormat(QStringView text, qint64 *seconds)
+{
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+
+    if (! (readNumber(text, 0, 4, &year) && isSeparator(text, 4, u'-')
+           && readNumber(text, 5, 2, &month) && isSeparator(text, 7, u'-')
+           && readNumber(text, 8, 2, &day) && isSeparator(text, 10, u'T')
+           && readNumber(text, 11, 2, &hour) && isSeparator(text, 13, u':')
+           && readNumber(text, 14, 2, &minute) && isSeparator(text, 16, u':')
+           && readNumber(text, 17, 2, &second))) {
+
+        return false;
+    }
+
+    // We leave special cases like leap seconds or "24:00:00" to Qt
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)
+        || hour > 23 || minute > 59 || second > 59) {
+
+        return false;
+    }
+
+    int position = 19;
+
+    // Skip fractions of a second
+    if (isSeparator(text, position, u'.') || isSeparator(text, position, u',')) {
+        position++;
+        const int fractionStart = position;
+        while (position < text.size() && text.at(position).unicode() >= u'0'
+               && text.at(position).unicode() <= u'9') {
+            position++;
+        }
+        if (position == fractionStart) {
+            return false;
+        }
+    }
+
+    // Parse the UTC offset. Without one, the time would be local time, which we leave to Qt.
+    int offset = 0;
+    if (isSeparator(text, position, u'Z')) {
+        position++;
+    } else if (isSeparator(text, position, u'+') || isSeparator(text, position, u'-')) {
+        const int sign = text.at(position).unicode() == u'-' ? -1 : 1;
+        int offsetHours;
+        int offsetMinutes = 0;
+        if (! readNumber(text, position + 1, 2, &offsetHours)) {
+            return false;
+        }
+        position += 3;
+        // The minutes are optional, but a colon has to be followed by them
+        const bool hasColon = isSeparator(text, position, u':');
+        if (hasColon) {
+            position++;
+        }
+        if (hasColon || position < text.size()) {
+            if (! readNumber(text, position, 2, &offsetMinutes)) {
+                return false;
+            }
+            position += 2;
+        }
+        if (offsetHours > 23 || offsetMinutes > 59) {
+            return false;
+        }
+        offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    } else {
+        return false;
+    }
+
+    if (position != text.size()) {
+        return false;
+    }
+
+    *seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second
+               - offset;
+    return true;
+}
+
+bool toSecsSinceEpoch(QStringView text, qint64 *seconds)
+{
+    text = text.trimmed();
+
+    if (parseFixedFormat(text, seconds)) {
+        return true;
+    }
+
+    // Fall back to Qt's generic parser for everything else
+    const auto dateTime = QDateTime::fromString(text.toString(), Qt::ISODate);
+    if (! dateTime.isValid()) {
+        return false;
+    }
+
+    // Drop the milliseconds, if any
+    *seconds = dateTime.toSecsSinceEpoch();
+    if (dateTime.time().msec() != 0 && *seconds < 0) {
+        // toSecsSinceEpoch rounds towards zero
+        (*seconds)--;
+    }
+    return true;
+}
+
+}
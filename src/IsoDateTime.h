@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef ISODATETIME_H
+#define ISODATETIME_H
+
+// Qt includes
+#include <QStringView>
+
+namespace IsoDateTime
+{
+
+// Parses an ISO 8601 date and time like "2021-03-14T15:09:26.535Z" or "2021-03-14T16:09:26+01:00"
+// and returns the whole seconds since the epoch (fractions of a second are dropped).
+// Returns false if the input is no valid date/time.
+bool toSecsSinceEpoch(QStringView text, qint64 *seconds);
+
+}
+
+#endif // ISODATETIME_H
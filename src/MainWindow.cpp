@@ -18,6 +18,7 @@
 #include "CoordinatesDialog.h"
 #include "RetrySkipAbortDialog.h"
 #include "ImagesModel.h"
+#include "ImageLoader.h"
 #include "ImagesListView.h"
 #include "Coordinates.h"
 #include "AutomaticMatchingWidget.h"
@@ -25,6 +26,8 @@
 #include "MapCenterInfo.h"
 #include "TracksListView.h"
 #include "GeoDataModel.h"
+#include "Track.h"
+#include "TrackLines.h"
 #include "TrackWalker.h"
 #include "Logging.h"
 #include "SearchPlacesWidget.h"
@@ -47,6 +50,10 @@
 #include <QTimer>
 #include <QMessageBox>
 #include <QVBoxLayout>
+#include <QFutureWatcher>
+#include <QEventLoop>
+#include <QTimeZone>
+#include <QtConcurrentMap>
 
 // C++ includes
 #include <functional>
@@ -61,6 +68,10 @@ static const QHash<QString, KExiv2Iface::KExiv2::MetadataWritingMode> s_writeMod
       KExiv2Iface::KExiv2::MetadataWritingMode::WRITETOSIDECARANDIMAGE }
 };
 
+// Loaded images are collected and added to the images model at most this often (in ms), so that
+// the model and the views don't have to be updated for each single image
+static const int s_addImagesInterval = 250;
+
 MainWindow::MainWindow(SharedObjects *sharedObjects)
     : KXmlGuiWindow(),
       m_sharedObjects(sharedObjects),
@@ -289,12 +300,12 @@ MainWindow::MainWindow(SharedObjects *sharedObjects)
     QTimer::singleShot(0, this, [this]
     {
         // We do this in a QTimer singleShot so that the main window
-        // will be already visible if this warning should be displayed
+        // will be already visible if this warning should be displayed.
+        // The data file itself is only read when it's needed for the first time.
         if (! m_gpxEngine->timeZoneDataLoaded()) {
             QMessageBox::warning(this, i18n("Loading timezone data"),
-                i18n("<p>Could not load or parse the timezone data files "
-                     "<kbd>timezones.json</kbd> and/or <kbd>timezones.png</kbd>. Automatic "
-                     "timezone detection won't work.</p>"
+                i18n("<p>Could not find the timezone data file <kbd>timezones.dat</kbd>. "
+                     "Automatic timezone detection won't work.</p>"
                      "<p>Please check your installation!</p>"
                      "<p>If you run manually compiled sources without having installed them, "
                      "please refer to <a href=\"https://community.kde.org/KGeoTag"
@@ -611,14 +622,43 @@ void MainWindow::addGpx(const QList<QString> &paths)
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
+    // All files that are not loaded yet are read concurrently. The read tracks are added here in
+    // the original order, each one as soon as it's available.
+
+    QList<QString> canonicalPaths;
+    QList<QString> pathsToRead;
     for (const auto &path : paths) {
+        const auto canonicalPath = QFileInfo(path).canonicalFilePath();
+        canonicalPaths.append(canonicalPath);
+        if (! m_geoDataModel->contains(canonicalPath)) {
+            pathsToRead.append(canonicalPath);
+        }
+    }
+
+    const auto *gpxEngine = m_gpxEngine;
+    const auto readTracks = QtConcurrent::mapped(pathsToRead, [gpxEngine](const QString &path)
+    {
+        TrackLines trackLines;
+        const auto info = gpxEngine->readGpx(path, &trackLines);
+        return qMakePair(info, trackLines);
+    });
+    int readIndex = 0;
+
+    for (int i = 0; i < filesCount; i++) {
         processed++;
 
+        const auto &path = paths.at(i);
         const QFileInfo info(path);
         m_settings->saveLastOpenPath(info.dir().absolutePath());
 
-        const auto [ result, tracks, segments, points ]
-            = m_gpxEngine->load(info.canonicalFilePath());
+        GpxEngine::LoadInfo loadInfo { GpxEngine::AlreadyLoaded };
+        if (readIndex < pathsToRead.count() && pathsToRead.at(readIndex) == canonicalPaths.at(i)) {
+            // This waits until the respective file has been read
+            const auto [ readInfo, trackLines ] = readTracks.resultAt(readIndex++);
+            loadInfo = m_gpxEngine->addTrack(canonicalPaths.at(i), readInfo, trackLines);
+        }
+
+        const auto [ result, tracks, segments, points ] = loadInfo;
 
         QString errorString;
 
@@ -789,105 +829,135 @@ void MainWindow::addImages(const QList<QString> &paths)
     int processed = 0;
     int loaded = 0;
     int alreadyLoaded = 0;
-    bool skipImage = false;
-    bool abortLoad = false;
 
     QProgressDialog progress(i18n("Loading images ..."), i18n("Cancel"), 0, requested, this);
     progress.setWindowModality(Qt::WindowModal);
 
+    // Sort out the images we already have and load all others in the background
+
+    QList<QString> loadPaths;
+    QHash<QString, QString> requestedPaths;
     for (const auto &path : paths) {
-        progress.setValue(processed++);
-        if (progress.wasCanceled()) {
-            break;
+        const QFileInfo info(path);
+        const auto canonicalPath = info.canonicalFilePath();
+        if (m_imagesModel->contains(canonicalPath) || requestedPaths.contains(canonicalPath)) {
+            progress.setValue(processed++);
+            alreadyLoaded++;
+            loaded++;
+            continue;
         }
+        requestedPaths.insert(canonicalPath, path);
+        loadPaths.append(canonicalPath);
+    }
 
-        const QFileInfo info(path);
-        while (true) {
-            QString errorString;
-            bool exitLoop = false;
+    ImageLoader loader(this, m_imagesModel);
+    connect(&progress, &QProgressDialog::canceled, &loader, &ImageLoader::abort);
 
-            switch (m_imagesModel->addImage(info.canonicalFilePath())) {
-            case ImagesModel::LoadingSucceeded:
-                exitLoop = true;
-                break;
+    // Add the loaded images to the model in batches
 
-            case ImagesModel::AlreadyLoaded:
-                alreadyLoaded++;
-                exitLoop = true;
-                break;
+    QList<QPair<QString, ImagesModel::LoadedImage>> pendingImages;
+    const auto addPendingImages = [&]
+    {
+        const int added = m_imagesModel->addLoadedImages(pendingImages);
+        loaded += pendingImages.count();
+        alreadyLoaded += pendingImages.count() - added;
+        pendingImages.clear();
+    };
 
-            case ImagesModel::LoadingImageFailed:
-                if (isSingleFile) {
-                    errorString = i18n("<p><b>Loading image failed</b></p>"
-                                       "<p>Could not read <kbd>%1</kbd>.</p>",
-                                       path);
-                } else {
-                    errorString = i18nc(
-                        "Message with a fraction of processed files added in round braces",
-                        "<p><b>Loading image failed (%1/%2)</b></p>"
-                        "<p>Could not read <kbd>%3</kbd>.</p>",
-                        processed, requested, path);
-                }
-                break;
+    QTimer addTimer;
+    addTimer.setSingleShot(true);
+    addTimer.setInterval(s_addImagesInterval);
+    connect(&addTimer, &QTimer::timeout, this, addPendingImages);
 
-            case ImagesModel::LoadingMetadataFailed:
-                if (isSingleFile) {
-                    errorString = i18n(
-                        "<p><b>Loading image's Exif header or XMP sidecar file failed</b></p>"
-                        "<p>Could not read <kbd>%1</kbd>.</p>",
-                        path);
-                } else {
-                    errorString = i18nc(
-                        "Message with a fraction of processed files added in round braces",
-                        "<p><b>Loading image's Exif header or XMP sidecar file failed</b></p>"
-                        "<p>Could not read <kbd>%2</kbd>.</p>",
-                        processed, requested, path);
-                }
-                break;
+    connect(&loader, &ImageLoader::imageLoaded,
+            this, [&](const QString &canonicalPath, const ImagesModel::LoadedImage &image)
+            {
+                progress.setValue(processed++);
 
-            }
+                const auto &path = requestedPaths.value(canonicalPath);
+                QString errorString;
 
-            if (exitLoop || errorString.isEmpty()) {
-                break;
-            }
+                switch (image.result) {
+                case ImagesModel::LoadingSucceeded:
+                case ImagesModel::AlreadyLoaded:
+                    pendingImages.append(qMakePair(canonicalPath, image));
+                    if (! addTimer.isActive()) {
+                        addTimer.start();
+                    }
+                    return;
+
+                case ImagesModel::LoadingImageFailed:
+                    if (isSingleFile) {
+                        errorString = i18n("<p><b>Loading image failed</b></p>"
+                                           "<p>Could not read <kbd>%1</kbd>.</p>",
+                                           path);
+                    } else {
+                        errorString = i18nc(
+                            "Message with a fraction of processed files added in round braces",
+                            "<p><b>Loading image failed (%1/%2)</b></p>"
+                            "<p>Could not read <kbd>%3</kbd>.</p>",
+                            processed, requested, path);
+                    }
+                    break;
+
+                case ImagesModel::LoadingMetadataFailed:
+                    if (isSingleFile) {
+                        errorString = i18n(
+                            "<p><b>Loading image's Exif header or XMP sidecar file failed</b></p>"
+                            "<p>Could not read <kbd>%1</kbd>.</p>",
+                            path);
+                    } else {
+                        errorString = i18nc(
+                            "Message with a fraction of processed files added in round braces",
+                            "<p><b>Loading image's Exif header or XMP sidecar file failed</b></p>"
+                            "<p>Could not read <kbd>%2</kbd>.</p>",
+                            processed, requested, path);
+                    }
+                    break;
 
-            errorString.append(i18n("<p>Please check if this file is actually a supported image "
-                                    "and if you have read access to it.</p>"));
+                }
 
-            if (isSingleFile) {
-                errorString.append(i18n("<p>You can retry to load this file or cancel the loading "
-                                        "process.</p>"));
-            } else {
-                errorString.append(i18n("<p>You can retry to load this file, skip it or cancel the "
-                                        "loading process.</p>"));
-            }
+                errorString.append(i18n("<p>Please check if this file is actually a supported "
+                                        "image and if you have read access to it.</p>"));
 
-            progress.reset();
-            QApplication::restoreOverrideCursor();
+                if (isSingleFile) {
+                    errorString.append(i18n("<p>You can retry to load this file or cancel the "
+                                            "loading process.</p>"));
+                } else {
+                    errorString.append(i18n("<p>You can retry to load this file, skip it or "
+                                            "cancel the loading process.</p>"));
+                }
 
-            RetrySkipAbortDialog dialog(this, i18n("Add images"), errorString, isSingleFile);
-            const auto reply = dialog.exec();
-            if (reply == RetrySkipAbortDialog::Skip) {
-                skipImage = true;
-                break;
-            } else if (reply == RetrySkipAbortDialog::Abort) {
-                abortLoad = true;
-                break;
-            }
+                // Hold back all further results until the user decided what to do. The images we
+                // already have are added, so that they are visible meanwhile.
+                loader.setPaused(true);
+                addTimer.stop();
+                addPendingImages();
+                progress.reset();
+                QApplication::restoreOverrideCursor();
+
+                RetrySkipAbortDialog dialog(this, i18n("Add images"), errorString, isSingleFile);
+                const auto reply = dialog.exec();
+                if (reply == RetrySkipAbortDialog::Retry) {
+                    processed--;
+                    loader.retry(canonicalPath);
+                } else if (reply == RetrySkipAbortDialog::Abort) {
+                    loader.abort();
+                }
 
-            QApplication::setOverrideCursor(Qt::WaitCursor);
-        }
+                QApplication::setOverrideCursor(Qt::WaitCursor);
+                loader.setPaused(false);
+            });
 
-        if (skipImage) {
-            skipImage = false;
-            continue;
-        }
-        if (abortLoad) {
-            break;
-        }
+    QEventLoop loop;
+    connect(&loader, &ImageLoader::finished, &loop, &QEventLoop::quit);
+    loader.load(loadPaths);
+    loop.exec();
 
-        loaded++;
-    }
+    addTimer.stop();
+    addPendingImages();
+
+    m_imagesModel->logMemoryUsage();
 
     progress.reset();
     m_mapWidget->reloadMap();
@@ -1088,56 +1158,153 @@ void MainWindow::matchAutomatically(const QList<QString> &paths, KGeoTag::Search
     int interpolatedMatches = 0;
     QString lastMatchedPath;
 
-    QProgressDialog progress(i18n("Assigning images ..."), i18n("Cancel"), 0, paths.count(), this);
-    progress.setWindowModality(Qt::WindowModal);
+    // Search all matches in worker threads
+
+    // The unmatched images are counted as their results come in, so that images that haven't been
+    // processed (because the search has been canceled) are not counted
 
-    int processed = 0;
     int notMatched = 0;
     int notMatchedButHaveCoordinates = 0;
+    const auto countNotMatched = [&](int index)
+    {
+        notMatched++;
+        if (m_imagesModel->coordinates(paths.at(index)).isSet()) {
+            notMatchedButHaveCoordinates++;
+        }
+    };
 
-    for (const auto &path : paths) {
-        progress.setValue(processed++);
-        if (progress.wasCanceled()) {
-            break;
+    // Images without a valid date are skipped by the search, so they can't be matched
+    QList<QDateTime> dates;
+    dates.reserve(paths.count());
+    int validDates = 0;
+    for (int i = 0; i < paths.count(); i++) {
+        const auto date = m_imagesModel->date(paths.at(i));
+        dates.append(date);
+        if (date.isValid()) {
+            validDates++;
+        } else {
+            countNotMatched(i);
         }
+    }
 
-        Coordinates coordinates;
+    QProgressDialog progress(i18n("Assigning images ..."), i18n("Cancel"), 0, validDates, this);
+    progress.setWindowModality(Qt::WindowModal);
 
-        // Search for exact matches if requested
+    int processed = 0;
+    int lastMatchedIndex = -1;
 
-        if (searchType == KGeoTag::CombinedMatchSearch
-            || searchType == KGeoTag::ExactMatchSearch) {
+    bool detectTimeZonePerImage = m_automaticMatchingWidget->detectTimeZonePerImage();
+    // Images that have been matched in another timezone than their own one, along with the
+    // timezone of the matched location
+    QList<QPair<int, QByteArray>> timeZoneChanged;
 
-            coordinates = m_gpxEngine->findExactCoordinates(
-                m_imagesModel->date(path), m_fixDriftWidget->cameraClockDeviation());
+    const auto applyResult = [&](int index, const GpxEngine::MatchResult &result)
+    {
+        const auto &[ coordinates, matchType ] = result;
+        if (matchType == KGeoTag::NotMatched) {
+            countNotMatched(index);
+            return;
         }
 
-        if (coordinates.isSet()) {
-            m_imagesModel->setCoordinates(path, coordinates, KGeoTag::ExactMatch);
+        const auto &path = paths.at(index);
+
+        if (detectTimeZonePerImage) {
+            const auto timeZoneId = m_gpxEngine->timeZoneId(coordinates);
+            if (! timeZoneId.isEmpty() && timeZoneId != m_imagesModel->timeZoneId(path)) {
+                // The image has to be matched again using the right timezone
+                timeZoneChanged.append(qMakePair(index, timeZoneId));
+                return;
+            }
+        }
+
+        if (matchType == KGeoTag::ExactMatch) {
             exactMatches++;
-            lastMatchedPath = path;
-            continue;
+        } else {
+            interpolatedMatches++;
         }
 
-        // Search for interpolated matches if requested
+        m_imagesModel->setCoordinates(path, coordinates, matchType);
+        lastMatchedIndex = std::max(lastMatchedIndex, index);
+    };
 
-        if (searchType == KGeoTag::CombinedMatchSearch
-            || searchType == KGeoTag::InterpolatedMatchSearch) {
+    // Search the matches for the given times in worker threads. The results are passed to
+    // applyBatchResult in batches as they come in. Returns false if the search has been canceled.
+    const auto matchConcurrently = [&](const QList<QDateTime> &times, auto applyBatchResult)
+    {
+        QFutureWatcher<GpxEngine::MatchBatch> watcher;
+
+        connect(&watcher, &QFutureWatcherBase::resultReadyAt,
+                this, [&](int resultIndex)
+                {
+                    const auto batch = watcher.resultAt(resultIndex);
+                    for (const auto &[ index, result ] : batch) {
+                        applyBatchResult(index, result);
+                    }
 
-            coordinates = m_gpxEngine->findInterpolatedCoordinates(
-                m_imagesModel->date(path), m_fixDriftWidget->cameraClockDeviation());
-        }
+                    processed += batch.count();
+                    progress.setValue(processed);
+                });
 
-        if (coordinates.isSet()) {
-            m_imagesModel->setCoordinates(path, coordinates, KGeoTag::InterpolatedMatch);
-            interpolatedMatches++;
-            lastMatchedPath = path;
-        } else {
-            notMatched++;
-            if (m_imagesModel->coordinates(path).isSet()) {
-                notMatchedButHaveCoordinates++;
+        connect(&progress, &QProgressDialog::canceled, &watcher, &QFutureWatcherBase::cancel);
+
+        // Keep the UI responsive until all workers are done (or have been canceled)
+        QEventLoop loop;
+        connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(m_gpxEngine->matchAllConcurrently(
+            times, m_fixDriftWidget->cameraClockDeviation(), searchType));
+        loop.exec();
+
+        return ! watcher.isCanceled();
+    };
+
+    bool canceled = ! matchConcurrently(dates, applyResult);
+
+    // Match all images again that turned out to have been taken in another timezone. This is only
+    // done once, so that images near a timezone border can't cause an endless loop.
+    if (! timeZoneChanged.isEmpty() && ! canceled) {
+        QList<QDateTime> changedDates;
+        changedDates.reserve(timeZoneChanged.count());
+        int validChangedDates = 0;
+        for (const auto &[ index, timeZoneId ] : std::as_const(timeZoneChanged)) {
+            const auto date = m_imagesModel->date(paths.at(index), timeZoneId);
+            if (date.isValid()) {
+                validChangedDates++;
+            } else {
+                // Invalid dates won't be matched
+                qCWarning(KGeoTagLog) << "Could not use the detected timezone" << timeZoneId
+                                      << "for" << paths.at(index);
+                countNotMatched(index);
             }
+            changedDates.append(date);
         }
+
+        qCDebug(KGeoTagLog) << "Matching" << validChangedDates
+                            << "image(s) again using their own timezone";
+
+        processed = 0;
+        progress.setLabelText(i18n("Assigning images using their own timezone ..."));
+        progress.setRange(0, validChangedDates);
+        progress.setValue(0);
+
+        // The detected timezone is only set if the image could be matched with it. Otherwise, it
+        // keeps its timezone and stays unmatched.
+        detectTimeZonePerImage = false;
+        const auto applyChangedResult = [&](int changedIndex, const GpxEngine::MatchResult &result)
+        {
+            const auto &[ index, timeZoneId ] = timeZoneChanged.at(changedIndex);
+            if (result.matchType != KGeoTag::NotMatched
+                && m_imagesModel->setImageTimeZone(paths.at(index), timeZoneId)) {
+
+                applyResult(index, result);
+            } else {
+                countNotMatched(index);
+            }
+        };
+        canceled = ! matchConcurrently(changedDates, applyChangedResult);
+    }
+
+    if (lastMatchedIndex != -1) {
+        lastMatchedPath = paths.at(lastMatchedIndex);
     }
 
     progress.reset();
@@ -1220,6 +1387,16 @@ void MainWindow::matchAutomatically(const QList<QString> &paths, KGeoTag::Search
         break;
     }
 
+    if (canceled) {
+        // Not all images have been processed, so we can't tell how many could not be matched
+        text = i18n("<p>The search has been canceled.</p>");
+        if (exactMatches > 0 || interpolatedMatches > 0) {
+            text.append(i18np("<p>One image has been assigned until then.</p>",
+                              "<p>%1 images have been assigned until then.</p>",
+                              exactMatches + interpolatedMatches));
+        }
+    }
+
     QApplication::restoreOverrideCursor();
 
     if (exactMatches > 0 || interpolatedMatches > 0) {
@@ -1228,6 +1405,8 @@ void MainWindow::matchAutomatically(const QList<QString> &paths, KGeoTag::Search
         m_mapWidget->centerImage(index);
         m_previewWidget->setImage(index);
         QMessageBox::information(this, title, text);
+    } else if (canceled) {
+        QMessageBox::information(this, title, text);
     } else {
         QMessageBox::warning(this, title, text);
     }
@@ -1749,9 +1928,14 @@ void MainWindow::removeEverything()
 
 void MainWindow::centerTrackPoint(int trackIndex, int trackPointIndex)
 {
-    const auto dateTime = m_geoDataModel->dateTimes().at(trackIndex).at(trackPointIndex)
-                              .toTimeZone(m_fixDriftWidget->imagesTimeZone());
-    const auto coordinates = m_geoDataModel->trackPoints().at(trackIndex).value(dateTime);
+    // The track walker walks through the points sorted by time
+    const auto &track = m_geoDataModel->tracks().at(trackIndex);
+    const auto time = track.sortedTime(trackPointIndex);
+    const auto dateTime = time != Track::invalidTime
+        ? QDateTime::fromSecsSinceEpoch(time, QTimeZone::utc())
+                     .toTimeZone(m_fixDriftWidget->imagesTimeZone())
+        : QDateTime();
+    const auto coordinates = track.sortedCoordinates(trackPointIndex);
     m_mapWidget->blockSignals(true);
     m_mapWidget->centerCoordinates(coordinates);
     m_mapCenterInfo->trackPointCentered(coordinates, dateTime);
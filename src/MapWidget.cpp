@@ -70,10 +70,10 @@ MapWidget::MapWidget(SharedObjects *sharedObjects, QWidget *parent)
     setProjection(Marble::Mercator);
     setMapThemeId(QStringLiteral("earth/openstreetmap/openstreetmap.dgml"));
 
-    auto *tracksLayer = new TracksLayer(this, m_geoDataModel, &m_trackPen);
-    auto *imagesLayer = new ImagesLayer(this, m_imagesModel);
-    addLayer(tracksLayer);
-    addLayer(imagesLayer);
+    m_tracksLayer = new TracksLayer(this, m_geoDataModel, &m_trackPen);
+    m_imagesLayer = new ImagesLayer(this, m_imagesModel);
+    addLayer(m_tracksLayer);
+    addLayer(m_imagesLayer);
 
     m_trackPen.setCapStyle(Qt::RoundCap);
     m_trackPen.setJoinStyle(Qt::RoundJoin);
@@ -214,6 +214,9 @@ void MapWidget::updateSettings()
     m_trackPen.setColor(m_settings->trackColor());
     m_trackPen.setWidth(m_settings->trackWidth());
     m_trackPen.setStyle(m_settings->trackStyle());
+    // The tracks have to be rendered again using the new pen
+    m_tracksLayer->clearCache();
+    m_imagesLayer->setClusterImages(m_settings->clusterImages());
     reloadMap();
 }
 
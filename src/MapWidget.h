@@ -26,6 +26,8 @@ class Settings;
 class GeoDataModel;
 class ImagesModel;
 class CoordinatesFormatter;
+class ImagesLayer;
+class TracksLayer;
 
 // Qt classes
 class QDragEnterEvent;
@@ -69,6 +71,8 @@ private: // Variables
     CoordinatesFormatter *m_coordinatesFormatter;
     QList<Marble::GeoDataLineString> m_tracks;
     QPen m_trackPen;
+    TracksLayer *m_tracksLayer;
+    ImagesLayer *m_imagesLayer;
     QMenu *m_contextMenu;
     QMenu *m_mapCenterMenu;
     QList<QAction *> m_floatersActions;
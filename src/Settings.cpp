@@ -41,6 +41,7 @@ static const QLatin1String s_showCrosshairs("showCrosshairs");
 static const QLatin1String s_centerLon("centerLon");
 static const QLatin1String s_centerLat("centerLat");
 static const QLatin1String s_zoom("zoom");
+static const QLatin1String s_clusterImages("clusterImages");
 
 // Floaters visibility
 static const QLatin1String s_floatersVisibility("floatersVisibility");
@@ -50,6 +51,7 @@ static const QLatin1String s_track("tracks");
 static const QLatin1String s_color("color");
 static const QLatin1String s_width("width");
 static const QLatin1String s_style("style");
+static const QLatin1String s_trackCacheSize("cacheSize");
 static const QList<Qt::PenStyle> s_trackStyleEnum {
     Qt::SolidLine,
     Qt::DashLine,
@@ -69,6 +71,9 @@ static const QList<QString> s_trackStyleString {
 static const QLatin1String s_images("images");
 static const QLatin1String s_thumnailSize("thumbnailSize");
 static const QLatin1String s_previewSize("previewSize");
+static const QLatin1String s_useEmbeddedPreviews("useEmbeddedPreviews");
+static const QLatin1String s_imageCacheSize("imageCacheSize");
+static const QLatin1String s_imagesMemoryLimit("imagesMemoryLimit");
 
 // Assignment
 
@@ -79,6 +84,7 @@ static const QLatin1String s_maximumInterpolationInterval("maximumInterpolationI
 static const QLatin1String s_maximumInterpolationDistance("maximumInterpolationDistance");
 static const QLatin1String s_excludeManuallyTaggedWhenReassigning(
                                "excludeManuallyTaggedWhenReassigning");
+static const QLatin1String s_detectTimeZonePerImage("detectTimeZonePerImage");
 
 static const QLatin1String s_defaultMatchingMode("defaultMatchingMode");
 static const QList<KGeoTag::SearchType> s_defaultMatchingModeEnum {
@@ -209,6 +215,19 @@ bool Settings::showCrosshairs() const
     return group.readEntry(s_showCrosshairs, true);
 }
 
+void Settings::saveClusterImages(bool state)
+{
+    auto group = m_config->group(s_map);
+    group.writeEntry(s_clusterImages, state);
+    group.sync();
+}
+
+bool Settings::clusterImages() const
+{
+    auto group = m_config->group(s_map);
+    return group.readEntry(s_clusterImages, false);
+}
+
 void Settings::saveMapCenter(const Coordinates &coordinates)
 {
     auto group = m_config->group(s_map);
@@ -310,6 +329,19 @@ int Settings::trackWidth() const
     return group.readEntry(s_width, 3);
 }
 
+void Settings::saveTrackCacheSize(int megabytes)
+{
+    auto group = m_config->group(s_track);
+    group.writeEntry(s_trackCacheSize, megabytes);
+    group.sync();
+}
+
+int Settings::trackCacheSize() const
+{
+    auto group = m_config->group(s_track);
+    return group.readEntry(s_trackCacheSize, 200);
+}
+
 // Images
 
 void Settings::saveThumbnailSize(int size)
@@ -338,6 +370,45 @@ int Settings::previewSize() const
     return group.readEntry(s_previewSize, 400);
 }
 
+void Settings::saveUseEmbeddedPreviews(bool state)
+{
+    auto group = m_config->group(s_images);
+    group.writeEntry(s_useEmbeddedPreviews, state);
+    group.sync();
+}
+
+bool Settings::useEmbeddedPreviews() const
+{
+    auto group = m_config->group(s_images);
+    return group.readEntry(s_useEmbeddedPreviews, true);
+}
+
+void Settings::saveImageCacheSize(int megabytes)
+{
+    auto group = m_config->group(s_images);
+    group.writeEntry(s_imageCacheSize, megabytes);
+    group.sync();
+}
+
+int Settings::imageCacheSize() const
+{
+    auto group = m_config->group(s_images);
+    return group.readEntry(s_imageCacheSize, 500);
+}
+
+void Settings::saveImagesMemoryLimit(int megabytes)
+{
+    auto group = m_config->group(s_images);
+    group.writeEntry(s_imagesMemoryLimit, megabytes);
+    group.sync();
+}
+
+int Settings::imagesMemoryLimit() const
+{
+    auto group = m_config->group(s_images);
+    return group.readEntry(s_imagesMemoryLimit, 512);
+}
+
 // Assignment
 
 void Settings::saveExactMatchTolerance(int seconds)
@@ -392,6 +463,19 @@ bool Settings::excludeManuallyTaggedWhenReassigning() const
     return group.readEntry(s_excludeManuallyTaggedWhenReassigning, true);
 }
 
+void Settings::saveDetectTimeZonePerImage(bool state)
+{
+    auto group = m_config->group(s_assignment);
+    group.writeEntry(s_detectTimeZonePerImage, state);
+    group.sync();
+}
+
+bool Settings::detectTimeZonePerImage() const
+{
+    auto group = m_config->group(s_assignment);
+    return group.readEntry(s_detectTimeZonePerImage, false);
+}
+
 // Elevation lookup
 
 void Settings::saveLookupElevationAutomatically(bool state)
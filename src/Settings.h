@@ -28,6 +28,9 @@ public:
     void saveShowCrosshairs(bool state);
     bool showCrosshairs() const;
 
+    void saveClusterImages(bool state);
+    bool clusterImages() const;
+
     void saveFloatersVisibility(const QHash<QString, bool> &data);
     QHash<QString, bool> floatersVisibility();
 
@@ -49,6 +52,15 @@ public:
     void savePreviewSize(int size);
     int previewSize() const;
 
+    void saveUseEmbeddedPreviews(bool state);
+    bool useEmbeddedPreviews() const;
+
+    void saveImageCacheSize(int megabytes);
+    int imageCacheSize() const;
+
+    void saveImagesMemoryLimit(int megabytes);
+    int imagesMemoryLimit() const;
+
     void saveExactMatchTolerance(int seconds);
     int exactMatchTolerance() const;
 
@@ -61,6 +73,9 @@ public:
     void saveExcludeManuallyTaggedWhenReassigning(bool state);
     bool excludeManuallyTaggedWhenReassigning() const;
 
+    void saveDetectTimeZonePerImage(bool state);
+    bool detectTimeZonePerImage() const;
+
     void saveLookupElevationAutomatically(bool state);
     bool lookupElevationAutomatically() const;
 
@@ -76,6 +91,9 @@ public:
     void saveTrackStyle(Qt::PenStyle style);
     Qt::PenStyle trackStyle() const;
 
+    void saveTrackCacheSize(int megabytes);
+    int trackCacheSize() const;
+
     void saveWriteMode(const QString &writeMode);
     QString writeMode() const;
 
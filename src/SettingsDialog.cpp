@@ -178,8 +178,35 @@ SettingsDialog::SettingsDialog(Settings *settings, QWidget *parent)
     sizesLayout->addWidget(m_previewSize, row, 1);
     sizesLayout->addWidget(new QLabel(i18n("px")), row, 2);
 
+    sizesLayout->addWidget(new QLabel(i18n("Cache size on disk:")), ++row, 0);
+    m_imageCacheSize = new QSpinBox;
+    m_imageCacheSize->setMinimum(0);
+    m_imageCacheSize->setMaximum(100000);
+    m_imageCacheSize->setSingleStep(100);
+    m_imageCacheSize->setSpecialValueText(i18n("Disabled"));
+    m_originalImageCacheSizeValue = m_settings->imageCacheSize();
+    m_imageCacheSize->setValue(m_originalImageCacheSizeValue);
+    sizesLayout->addWidget(m_imageCacheSize, row, 1);
+    sizesLayout->addWidget(new QLabel(i18n("MiB")), row, 2);
+
+    sizesLayout->addWidget(new QLabel(i18n("Memory for thumbnails and previews:")), ++row, 0);
+    m_imagesMemoryLimit = new QSpinBox;
+    m_imagesMemoryLimit->setMinimum(64);
+    m_imagesMemoryLimit->setMaximum(100000);
+    m_imagesMemoryLimit->setSingleStep(64);
+    m_originalImagesMemoryLimitValue = m_settings->imagesMemoryLimit();
+    m_imagesMemoryLimit->setValue(m_originalImagesMemoryLimitValue);
+    sizesLayout->addWidget(m_imagesMemoryLimit, row, 1);
+    sizesLayout->addWidget(new QLabel(i18n("MiB")), row, 2);
+
     sizesLayoutWrapper->addStretch();
 
+    m_useEmbeddedPreviews = new QCheckBox(i18n("Use previews embedded in the image files if they "
+                                                "are big enough (faster, esp. for RAW images)"));
+    m_originalUseEmbeddedPreviewsValue = m_settings->useEmbeddedPreviews();
+    m_useEmbeddedPreviews->setChecked(m_originalUseEmbeddedPreviewsValue);
+    imagesBoxLayout->addWidget(m_useEmbeddedPreviews);
+
     auto *imagesChangesLabel = new QLabel(i18n("Please restart the program after changes to these "
                                                "values so that they are applied and become "
                                                "visible."));
@@ -228,6 +255,42 @@ SettingsDialog::SettingsDialog(Settings *settings, QWidget *parent)
 
     trackBoxLayout->addStretch();
 
+    // GPX files
+
+    auto *gpxBox = new QGroupBox(i18n("GPX files"));
+    auto *gpxBoxLayout = new QVBoxLayout(gpxBox);
+    layout->addWidget(gpxBox);
+
+    auto *trackCacheLayout = new QHBoxLayout;
+    gpxBoxLayout->addLayout(trackCacheLayout);
+    trackCacheLayout->addWidget(new QLabel(i18n("Cache size on disk:")));
+    m_trackCacheSize = new QSpinBox;
+    m_trackCacheSize->setMinimum(0);
+    m_trackCacheSize->setMaximum(100000);
+    m_trackCacheSize->setSingleStep(50);
+    m_trackCacheSize->setSpecialValueText(i18n("Disabled"));
+    m_originalTrackCacheSizeValue = m_settings->trackCacheSize();
+    m_trackCacheSize->setValue(m_originalTrackCacheSizeValue);
+    trackCacheLayout->addWidget(m_trackCacheSize);
+    trackCacheLayout->addWidget(new QLabel(i18n("MiB")));
+    trackCacheLayout->addStretch();
+
+    auto *gpxChangesLabel = new QLabel(i18n("Please restart the program after changing the cache "
+                                            "size so that it is applied."));
+    gpxChangesLabel->setWordWrap(true);
+    gpxBoxLayout->addWidget(gpxChangesLabel);
+
+    // Images on the map
+
+    auto *mapImagesBox = new QGroupBox(i18n("Images on the map"));
+    auto *mapImagesBoxLayout = new QVBoxLayout(mapImagesBox);
+    layout->addWidget(mapImagesBox);
+
+    m_clusterImages = new QCheckBox(i18n("Combine images close to each other to one thumbnail "
+                                         "showing the number of images"));
+    m_clusterImages->setChecked(m_settings->clusterImages());
+    mapImagesBoxLayout->addWidget(m_clusterImages);
+
     // Elevation lookup
 
     auto *elevationBox = new QGroupBox(i18n("Elevation lookup"));
@@ -389,10 +452,20 @@ void SettingsDialog::accept()
     m_settings->saveThumbnailSize(thumbnailSize);
     const auto previewSize = m_previewSize->value();
     m_settings->savePreviewSize(previewSize);
+    const auto useEmbeddedPreviews = m_useEmbeddedPreviews->isChecked();
+    m_settings->saveUseEmbeddedPreviews(useEmbeddedPreviews);
+    const auto imageCacheSize = m_imageCacheSize->value();
+    m_settings->saveImageCacheSize(imageCacheSize);
+    const auto imagesMemoryLimit = m_imagesMemoryLimit->value();
+    m_settings->saveImagesMemoryLimit(imagesMemoryLimit);
 
     m_settings->saveTrackColor(m_currentTrackColor);
     m_settings->saveTrackWidth(m_trackWidth->value());
     m_settings->saveTrackStyle(static_cast<Qt::PenStyle>(m_trackStyle->currentData().toInt()));
+    const auto trackCacheSize = m_trackCacheSize->value();
+    m_settings->saveTrackCacheSize(trackCacheSize);
+
+    m_settings->saveClusterImages(m_clusterImages->isChecked());
 
     m_settings->saveLookupElevationAutomatically(m_lookupElevationAutomatically->isChecked());
     m_settings->saveElevationDataset(m_elevationDataset->currentData().toString());
@@ -402,7 +475,11 @@ void SettingsDialog::accept()
     m_settings->saveCreateBackups(m_createBackups->isChecked());
 
     if (   thumbnailSize != m_originalThumbnailSizeValue
-        || previewSize != m_originalPreviewSizeValue) {
+        || previewSize != m_originalPreviewSizeValue
+        || useEmbeddedPreviews != m_originalUseEmbeddedPreviewsValue
+        || imageCacheSize != m_originalImageCacheSizeValue
+        || imagesMemoryLimit != m_originalImagesMemoryLimitValue
+        || trackCacheSize != m_originalTrackCacheSizeValue) {
 
         QMessageBox::information(this, i18n("Settings changed"),
             i18n("Please restart KGeoTag to apply the changed settings and make them visible!"));
@@ -51,9 +51,15 @@ private: // Variables
 
     QSpinBox *m_thumbnailSize;
     QSpinBox *m_previewSize;
+    QCheckBox *m_useEmbeddedPreviews;
+    QSpinBox *m_imageCacheSize;
+    QSpinBox *m_imagesMemoryLimit;
     bool m_originalSplitImagesListValue;
     int m_originalThumbnailSizeValue;
     int m_originalPreviewSizeValue;
+    bool m_originalUseEmbeddedPreviewsValue;
+    int m_originalImageCacheSizeValue;
+    int m_originalImagesMemoryLimitValue;
 
     QColor m_currentTrackColor;
     QPushButton *m_trackColor;
@@ -61,6 +67,11 @@ private: // Variables
     QSpinBox *m_trackWidth;
     QComboBox *m_trackStyle;
 
+    QSpinBox *m_trackCacheSize;
+    int m_originalTrackCacheSizeValue;
+
+    QCheckBox *m_clusterImages;
+
     QCheckBox *m_lookupElevationAutomatically;
     QComboBox *m_elevationDataset;
 
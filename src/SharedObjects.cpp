@@ -17,9 +17,12 @@ SharedObjects::SharedObjects(QObject *parent) : QObject(parent)
 {
     m_settings = new Settings(this);
     m_imagesModel = new ImagesModel(this, m_settings->splitImagesList(),
-                                    m_settings->thumbnailSize(), m_settings->previewSize());
+                                    m_settings->thumbnailSize(), m_settings->previewSize(),
+                                    m_settings->useEmbeddedPreviews(),
+                                    m_settings->imageCacheSize(),
+                                    m_settings->imagesMemoryLimit());
     m_geoDataModel = new GeoDataModel(this);
-    m_gpxEngine = new GpxEngine(this, m_geoDataModel);
+    m_gpxEngine = new GpxEngine(this, m_geoDataModel, m_settings->trackCacheSize());
     m_elevationEngine = new ElevationEngine(this, m_settings);
     m_coordinatesFormatter = new CoordinatesFormatter(this, &m_locale, m_settings);
     m_coordinatesParser = new CoordinatesParser(this, &m_locale);
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "TimeZoneLookup.h"
+#include "Logging.h"
+
+// Qt includes
+#include <QStandardPaths>
+#include <QFile>
+#include <QDataStream>
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+
+static const char *s_magic = "KGTZ";
+static const quint32 s_version = 1;
+
+// Used for map pixels without a known timezone
+static const quint16 s_noTimeZone = 0xFFFF;
+
+TimeZoneLookup::TimeZoneLookup()
+{
+    m_dataFile = QStandardPaths::locate(QStandardPaths::AppDataLocation,
+                                        QStringLiteral("timezones.dat"));
+    if (m_dataFile.isEmpty()) {
+        // This should not happen
+        qCWarning(KGeoTagLog) << "Could not find the timezone data file!";
+    }
+}
+
+bool TimeZoneLookup::isAvailable() const
+{
+    return ! m_dataFile.isEmpty();
+}
+
+void TimeZoneLookup::load() const
+{
+    QFile file(m_dataFile);
+    if (! file.open(QIODevice::ReadOnly)) {
+        qCWarning(KGeoTagLog) << "Could not open the timezone data file" << m_dataFile;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    char magic[4];
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 count;
+    if (stream.readRawData(magic, 4) != 4 || qstrncmp(magic, s_magic, 4) != 0) {
+        qCWarning(KGeoTagLog) << m_dataFile << "is no timezone data file!";
+        return;
+    }
+    stream >> version >> width >> height >> count;
+    if (version != s_version || width == 0 || width > s_noTimeZone || height == 0
+        || count >= s_noTimeZone) {
+
+        qCWarning(KGeoTagLog) << "Unsupported timezone data file" << m_dataFile;
+        return;
+    }
+
+    LookupData data;
+    data.width = int(width);
+    data.height = int(height);
+
+    for (quint32 i = 0; i < count; i++) {
+        quint8 length;
+        stream >> length;
+        QByteArray id(length, '\0');
+        stream.readRawData(id.data(), length);
+        data.timeZoneIds.append(id);
+    }
+
+    data.rowOffsets.resize(height + 1);
+    for (auto &offset : data.rowOffsets) {
+        stream >> offset;
+    }
+
+    const auto runs = data.rowOffsets.last();
+    if (stream.status() != QDataStream::Ok || data.rowOffsets.first() != 0
+        || ! std::is_sorted(data.rowOffsets.constBegin(), data.rowOffsets.constEnd())
+        || qint64(runs) * 4 != file.size() - file.pos()) {
+
+        qCWarning(KGeoTagLog) << "Broken timezone data file" << m_dataFile;
+        return;
+    }
+
+    data.runEnds.resize(runs);
+    data.runTimeZones.resize(runs);
+    for (quint32 i = 0; i < runs; i++) {
+        stream >> data.runEnds[i] >> data.runTimeZones[i];
+        if (data.runTimeZones.at(i) >= count && data.runTimeZones.at(i) != s_noTimeZone) {
+            qCWarning(KGeoTagLog) << "Broken timezone data file" << m_dataFile;
+            return;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KGeoTagLog) << "Broken timezone data file" << m_dataFile;
+        return;
+    }
+
+    qCDebug(KGeoTagLog) << "Loaded" << count << "timezones and" << runs << "map runs from"
+                        << m_dataFile;
+    m_data = data;
+}
+
+QByteArray TimeZoneLookup::timeZoneId(double lon, double lat) const
+{
+    if (! isAvailable()) {
+        return QByteArray();
+    }
+
+    std::call_once(m_loadFlag, [this]
+    {
+        load();
+    });
+
+    if (m_data.rowOffsets.isEmpty()) {
+        // Loading the data failed
+        return QByteArray();
+    }
+
+    // Scale the coordinates to the map size, relative to the map center
+    int x = std::round(lon / 180.0 * (m_data.width / 2.0));
+    int y = std::round(lat / 90.0 * (m_data.height / 2.0));
+
+    // Move the mapped coordinates to the left upper edge
+    x = std::clamp(m_data.width / 2 + x, 0, m_data.width - 1);
+    y = std::clamp(m_data.height - (m_data.height / 2 + y), 0, m_data.height - 1);
+
+    // Find the run containing the column
+    const auto rowBegin = m_data.runEnds.constBegin() + m_data.rowOffsets.at(y);
+    const auto rowEnd = m_data.runEnds.constBegin() + m_data.rowOffsets.at(y + 1);
+    const auto run = std::upper_bound(rowBegin, rowEnd, quint16(x));
+    if (run == rowEnd) {
+        return QByteArray();
+    }
+
+    const auto timeZone = m_data.runTimeZones.at(run - m_data.runEnds.constBegin());
+    return timeZone == s_noTimeZone ? QByteArray() : m_data.timeZoneIds.at(timeZone);
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef TIMEZONELOOKUP_H
+#define TIMEZONELOOKUP_H
+
+// Qt includes
+#include <QString>
+#include <QByteArray>
+#include <QList>
+
+// C++ includes
+#include <mutex>
+
+// Looks up the timezone for a location using the precompiled timezones.dat file (cf.
+// timezones/compile_timezones_lookup.py). The file is only read when the first lookup is done.
+class TimeZoneLookup
+{
+
+public:
+    explicit TimeZoneLookup();
+    bool isAvailable() const;
+
+    // Returns an empty QByteArray if the timezone could not be determined. This is thread-safe.
+    QByteArray timeZoneId(double lon, double lat) const;
+
+private: // Structs
+    struct LookupData
+    {
+        int width = 0;
+        int height = 0;
+        QList<QByteArray> timeZoneIds;
+        // The index of each row's first run (plus the end of the last row)
+        QList<quint32> rowOffsets;
+        // The column after each run and the index of the run's timezone
+        QList<quint16> runEnds;
+        QList<quint16> runTimeZones;
+    };
+
+private: // Functions
+    void load() const;
+
+private: // Variables
+    QString m_dataFile;
+    mutable std::once_flag m_loadFlag;
+    mutable LookupData m_data;
+
+};
+
+#endif // TIMEZONELOOKUP_H
@@ -0,0 +1,298 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "Track.h"
+
+// Marble includes
+#include <marble/GeoDataLatLonBox.h>
+#include <marble/GeoDataCoordinates.h>
+
+// C++ includes
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <utility>
+
+// The header of a track's binary snapshot. It's followed by the points' times, longitudes,
+// latitudes and altitudes, the segment starts and the time order.
+struct DataHeader
+{
+    qint32 points;
+    qint32 segments;
+    qint32 timeOrder;
+    qint32 firstTimedPoint;
+    double north;
+    double south;
+    double east;
+    double west;
+};
+
+template<typename T>
+static void appendData(QByteArray &data, const QList<T> &list)
+{
+    data.append(reinterpret_cast<const char *>(list.constData()),
+                qsizetype(list.count()) * qsizetype(sizeof(T)));
+}
+
+template<typename T>
+static bool readData(const char *&data, const char *end, int count, QList<T> &list)
+{
+    const auto size = qsizetype(count) * qsizetype(sizeof(T));
+    if (count < 0 || end - data < size) {
+        return false;
+    }
+
+    list.resize(count);
+    std::memcpy(list.data(), data, size_t(size));
+    data += size;
+    return true;
+}
+
+Track::Track()
+{
+}
+
+void Track::startSegment()
+{
+    // Don't add empty segments
+    if (! m_segmentStarts.isEmpty() && m_segmentStarts.last() == m_times.count()) {
+        return;
+    }
+
+    m_segmentStarts.append(m_times.count());
+}
+
+void Track::appendPoint(qint64 time, double lon, double lat, double alt)
+{
+    if (m_segmentStarts.isEmpty()) {
+        m_segmentStarts.append(0);
+    }
+
+    m_times.append(time);
+    m_lons.append(lon);
+    m_lats.append(lat);
+    m_alts.append(float(alt));
+}
+
+void Track::finish()
+{
+    // Remove a trailing empty segment
+    if (! m_segmentStarts.isEmpty() && m_segmentStarts.last() == m_times.count()) {
+        m_segmentStarts.removeLast();
+    }
+
+    // Sort the points by their time. Normally, a track is recorded chronologically, so we only
+    // need a sorted index if the points are out of order.
+    m_timeOrder.clear();
+    if (! std::is_sorted(m_times.constBegin(), m_times.constEnd())) {
+        m_timeOrder.resize(m_times.count());
+        std::iota(m_timeOrder.begin(), m_timeOrder.end(), 0);
+        std::stable_sort(m_timeOrder.begin(), m_timeOrder.end(),
+                         [this](int point1, int point2)
+                         {
+                             return m_times.at(point1) < m_times.at(point2);
+                         });
+    }
+
+    m_firstTimedPoint = 0;
+    while (m_firstTimedPoint < m_times.count() && sortedTime(m_firstTimedPoint) == invalidTime) {
+        m_firstTimedPoint++;
+    }
+
+    // Calculate the bounding box
+
+    if (m_times.isEmpty()) {
+        m_box = Marble::GeoDataLatLonAltBox();
+        return;
+    }
+
+    const auto [ south, north ] = std::minmax_element(m_lats.constBegin(), m_lats.constEnd());
+
+    // Like Marble's line strings' boxes, the box crosses the date line if the track does. We
+    // calculate the longitudes' extent a second time with all of them shifted to 0° to 360°. If
+    // that's narrower, the points lie around the date line rather than around 0°.
+
+    double west = 180.0;
+    double east = -180.0;
+    double shiftedWest = 360.0;
+    double shiftedEast = 0.0;
+    for (const double lon : std::as_const(m_lons)) {
+        west = std::min(west, lon);
+        east = std::max(east, lon);
+        const double shiftedLon = lon < 0.0 ? lon + 360.0 : lon;
+        shiftedWest = std::min(shiftedWest, shiftedLon);
+        shiftedEast = std::max(shiftedEast, shiftedLon);
+    }
+
+    if (shiftedEast - shiftedWest < east - west) {
+        // West is greater than east now, which is how GeoDataLatLonBox represents a box crossing
+        // the date line
+        west = shiftedWest > 180.0 ? shiftedWest - 360.0 : shiftedWest;
+        east = shiftedEast > 180.0 ? shiftedEast - 360.0 : shiftedEast;
+    }
+
+    m_box = Marble::GeoDataLatLonAltBox(Marble::GeoDataLatLonBox(
+        *north, *south, east, west, Marble::GeoDataCoordinates::Degree), 0.0, 0.0);
+}
+
+int Track::count() const
+{
+    return m_times.count();
+}
+
+int Track::segmentCount() const
+{
+    return m_segmentStarts.count();
+}
+
+int Track::segmentStart(int segment) const
+{
+    return m_segmentStarts.at(segment);
+}
+
+int Track::segmentEnd(int segment) const
+{
+    // This is the index after the segment's last point
+    return segment + 1 < m_segmentStarts.count() ? m_segmentStarts.at(segment + 1)
+                                                  : m_times.count();
+}
+
+qint64 Track::time(int point) const
+{
+    return m_times.at(point);
+}
+
+double Track::lon(int point) const
+{
+    return m_lons.at(point);
+}
+
+double Track::lat(int point) const
+{
+    return m_lats.at(point);
+}
+
+Coordinates Track::coordinates(int point) const
+{
+    return Coordinates(m_lons.at(point), m_lats.at(point), m_alts.at(point), true);
+}
+
+int Track::firstTimedPoint() const
+{
+    return m_firstTimedPoint;
+}
+
+int Track::sortedPoint(int index) const
+{
+    return m_timeOrder.isEmpty() ? index : m_timeOrder.at(index);
+}
+
+int Track::sortedUpperBound(qint64 time) const
+{
+    // Find the first point later than the given time
+
+    if (m_timeOrder.isEmpty()) {
+        return std::upper_bound(m_times.constBegin(), m_times.constEnd(), time)
+               - m_times.constBegin();
+    }
+
+    return std::upper_bound(m_timeOrder.constBegin(), m_timeOrder.constEnd(), time,
+                            [this](qint64 searchedTime, int point)
+                            {
+                                return searchedTime < m_times.at(point);
+                            }) - m_timeOrder.constBegin();
+}
+
+qint64 Track::sortedTime(int index) const
+{
+    return m_times.at(sortedPoint(index));
+}
+
+Coordinates Track::sortedCoordinates(int index) const
+{
+    return coordinates(sortedPoint(index));
+}
+
+const Marble::GeoDataLatLonAltBox &Track::box() const
+{
+    return m_box;
+}
+
+QByteArray Track::toData() const
+{
+    DataHeader header;
+    header.points = m_times.count();
+    header.segments = m_segmentStarts.count();
+    header.timeOrder = m_timeOrder.count();
+    header.firstTimedPoint = m_firstTimedPoint;
+    header.north = m_box.north(Marble::GeoDataCoordinates::Degree);
+    header.south = m_box.south(Marble::GeoDataCoordinates::Degree);
+    header.east = m_box.east(Marble::GeoDataCoordinates::Degree);
+    header.west = m_box.west(Marble::GeoDataCoordinates::Degree);
+
+    QByteArray data;
+    data.reserve(qsizetype(sizeof(DataHeader))
+                 + qsizetype(m_times.count()) * qsizetype(sizeof(qint64) + 2 * sizeof(double)
+                                                           + sizeof(float))
+                 + qsizetype(m_segmentStarts.count() + m_timeOrder.count())
+                   * qsizetype(sizeof(int)));
+
+    data.append(reinterpret_cast<const char *>(&header), sizeof(DataHeader));
+    appendData(data, m_times);
+    appendData(data, m_lons);
+    appendData(data, m_lats);
+    appendData(data, m_alts);
+    appendData(data, m_segmentStarts);
+    appendData(data, m_timeOrder);
+
+    return data;
+}
+
+bool Track::fromData(const char *data, qint64 size, Track *track)
+{
+    if (size < qint64(sizeof(DataHeader))) {
+        return false;
+    }
+
+    DataHeader header;
+    std::memcpy(&header, data, sizeof(DataHeader));
+    const char *end = data + size;
+    data += sizeof(DataHeader);
+
+    if (! (readData(data, end, header.points, track->m_times)
+           && readData(data, end, header.points, track->m_lons)
+           && readData(data, end, header.points, track->m_lats)
+           && readData(data, end, header.points, track->m_alts)
+           && readData(data, end, header.segments, track->m_segmentStarts)
+           && readData(data, end, header.timeOrder, track->m_timeOrder))
+        || data != end
+        || (header.timeOrder != 0 && header.timeOrder != header.points)
+        || header.firstTimedPoint < 0 || header.firstTimedPoint > header.points) {
+
+        return false;
+    }
+
+    // Be sure not to access anything out of range if we got broken data
+    const auto isValidPoint = [&header](int point)
+    {
+        return point >= 0 && point < header.points;
+    };
+    if (! std::all_of(track->m_segmentStarts.constBegin(), track->m_segmentStarts.constEnd(),
+                      isValidPoint)
+        || ! std::all_of(track->m_timeOrder.constBegin(), track->m_timeOrder.constEnd(),
+                         isValidPoint)) {
+
+        return false;
+    }
+
+    track->m_firstTimedPoint = header.firstTimedPoint;
+    track->m_box = header.points == 0
+        ? Marble::GeoDataLatLonAltBox()
+        : Marble::GeoDataLatLonAltBox(Marble::GeoDataLatLonBox(
+              header.north, header.south, header.east, header.west,
+              Marble::GeoDataCoordinates::Degree), 0.0, 0.0);
+
+    return true;
+}
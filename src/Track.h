@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef TRACK_H
+#define TRACK_H
+
+// Local includes
+#include "Coordinates.h"
+
+// Marble includes
+#include <marble/GeoDataLatLonAltBox.h>
+
+// Qt includes
+#include <QList>
+#include <QByteArray>
+
+// C++ includes
+#include <limits>
+
+// The points of one loaded GPX file. They are kept in flat arrays (one per property), in the order
+// they have been added. All members are implicitly shared, so that a copy is cheap.
+class Track
+{
+
+public:
+    // Used for points without a (valid) timestamp. They are sorted before all others.
+    static constexpr qint64 invalidTime = std::numeric_limits<qint64>::min();
+
+    explicit Track();
+
+    // The track is built by adding the points one by one, in the order they have been recorded.
+    // finish() has to be called when all points have been added.
+    void startSegment();
+    void appendPoint(qint64 time, double lon, double lat, double alt);
+    void finish();
+
+    int count() const;
+    int segmentCount() const;
+    int segmentStart(int segment) const;
+    int segmentEnd(int segment) const;
+
+    qint64 time(int point) const;
+    double lon(int point) const;
+    double lat(int point) const;
+    Coordinates coordinates(int point) const;
+
+    // Access to the points sorted by their time. Points with the same time keep the order they
+    // have been added in.
+    int firstTimedPoint() const;
+    int sortedPoint(int index) const;
+    int sortedUpperBound(qint64 time) const;
+    qint64 sortedTime(int index) const;
+    Coordinates sortedCoordinates(int index) const;
+
+    const Marble::GeoDataLatLonAltBox &box() const;
+
+    // A compact binary snapshot of a finished track (in native byte order), used by the TrackCache
+    QByteArray toData() const;
+    static bool fromData(const char *data, qint64 size, Track *track);
+
+private: // Variables
+    QList<qint64> m_times;
+    QList<double> m_lons;
+    QList<double> m_lats;
+    QList<float> m_alts;
+
+    // The index of each segment's first point
+    QList<int> m_segmentStarts;
+
+    // The points' indices, sorted by their time. Empty if the points already are sorted.
+    QList<int> m_timeOrder;
+    int m_firstTimedPoint = 0;
+
+    Marble::GeoDataLatLonAltBox m_box;
+
+};
+
+#endif // TRACK_H
@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "TrackCache.h"
+#include "Track.h"
+#include "Logging.h"
+
+// Qt includes
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QMutexLocker>
+
+// C++ includes
+#include <cstring>
+
+static const quint32 s_magic = 0x4B475454; // "KGTT"
+static const quint32 s_version = 3;
+
+// When the cache grows too big, we delete the least recently used entries until it's this much of
+// the maximum size again, so that we don't have to clean up again with the next track
+static const double s_evictionTarget = 0.9;
+
+// The header of a cache file. It's followed by the track's snapshot and the significance of each
+// of its points (cf. TrackLines). The data is written in native byte order, so that it can be used
+// directly. A file written on a machine with another byte order won't have a matching magic number.
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    qint64 lastModified;
+    qint64 size;
+    qint32 tracks;
+    qint32 segments;
+    qint32 points;
+    qint32 padding;
+    qint64 trackSize;
+};
+
+TrackCache::TrackCache(QObject *parent, int maximumSize)
+    : QObject(parent),
+      m_maximumSize(qint64(maximumSize) * 1024 * 1024)
+{
+    if (m_maximumSize == 0) {
+        return;
+    }
+
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                  + QStringLiteral("/tracks");
+    if (! QDir().mkpath(m_directory)) {
+        qCWarning(KGeoTagLog) << "Could not create the track cache directory" << m_directory;
+        m_directory.clear();
+    }
+}
+
+bool TrackCache::isEnabled() const
+{
+    return ! m_directory.isEmpty();
+}
+
+QString TrackCache::cacheFile(const QFileInfo &info) const
+{
+    // Each entry is identified by the GPX file's path. Timestamps without an UTC offset are read
+    // as local time, so the system's timezone is part of the key, too. The file's mtime and size
+    // are stored in the entry to check if it's still valid. Entries that are not used anymore
+    // (e.g. for moved or deleted files) will be evicted eventually.
+
+    const auto canonicalPath = info.canonicalFilePath();
+    if (canonicalPath.isEmpty()) {
+        return QString();
+    }
+
+    const auto key = canonicalPath + QLatin1Char('\n')
+                     + QString::fromUtf8(QTimeZone::systemTimeZoneId());
+
+    return m_directory + QLatin1Char('/')
+           + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(),
+                                                          QCryptographicHash::Sha1).toHex());
+}
+
+bool TrackCache::read(const QString &path, Track *track, QList<float> *significances,
+                      GpxEngine::LoadInfo *info)
+{
+    if (! isEnabled()) {
+        return false;
+    }
+
+    const QFileInfo gpxInfo(path);
+    const auto fileName = cacheFile(gpxInfo);
+    if (fileName.isEmpty()) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (! file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(Header))) {
+        return false;
+    }
+
+    auto *data = file.map(0, file.size());
+    if (data == nullptr) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    const auto *trackData = reinterpret_cast<const char *>(data) + sizeof(Header);
+    const qint64 dataSize = file.size() - qint64(sizeof(Header));
+
+    const bool success
+        = header.magic == s_magic && header.version == s_version
+          && header.lastModified == gpxInfo.lastModified().toMSecsSinceEpoch()
+          && header.size == gpxInfo.size()
+          && header.trackSize >= 0 && header.trackSize <= dataSize
+          && Track::fromData(trackData, header.trackSize, track)
+          && dataSize - header.trackSize == qint64(track->count()) * qint64(sizeof(float));
+
+    if (success) {
+        significances->resize(track->count());
+        std::memcpy(significances->data(), trackData + header.trackSize,
+                    std::size_t(dataSize - header.trackSize));
+    }
+
+    file.unmap(data);
+
+    if (! success) {
+        *track = Track();
+        return false;
+    }
+
+    // Mark the entry as recently used, so that it's evicted last
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    *info = { GpxEngine::Okay, header.tracks, header.segments, header.points };
+    return true;
+}
+
+void TrackCache::store(const QString &path, const Track &track,
+                       const QList<float> &significances, const GpxEngine::LoadInfo &info)
+{
+    if (! isEnabled()) {
+        return;
+    }
+
+    const QFileInfo gpxInfo(path);
+    const auto fileName = cacheFile(gpxInfo);
+    if (fileName.isEmpty() || significances.count() != track.count()) {
+        return;
+    }
+
+    const auto trackData = track.toData();
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.magic = s_magic;
+    header.version = s_version;
+    header.lastModified = gpxInfo.lastModified().toMSecsSinceEpoch();
+    header.size = gpxInfo.size();
+    header.tracks = info.tracks;
+    header.segments = info.segments;
+    header.points = info.points;
+    header.trackSize = trackData.size();
+
+    QSaveFile file(fileName);
+    if (! file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(trackData);
+    file.write(reinterpret_cast<const char *>(significances.constData()),
+               qint64(significances.count()) * qint64(sizeof(float)));
+    const auto size = file.size();
+    if (! file.commit()) {
+        qCWarning(KGeoTagLog) << "Could not write the track cache file" << fileName;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_currentSize == -1) {
+        // We didn't check the cache's size yet in this session. This also includes the file we
+        // just wrote.
+        evict();
+    } else {
+        m_currentSize += size;
+        if (m_currentSize > m_maximumSize) {
+            evict();
+        }
+    }
+}
+
+void TrackCache::evict()
+{
+    // This has to be called with m_mutex being locked
+
+    const auto entries = QDir(m_directory).entryInfoList(QDir::Files,
+                                                         QDir::Time | QDir::Reversed);
+
+    m_currentSize = 0;
+    for (const auto &entry : entries) {
+        m_currentSize += entry.size();
+    }
+
+    if (m_currentSize <= m_maximumSize) {
+        return;
+    }
+
+    // The entries are sorted by their mtime, the least recently used one first
+    const auto targetSize = qint64(double(m_maximumSize) * s_evictionTarget);
+    for (const auto &entry : entries) {
+        if (m_currentSize <= targetSize) {
+            break;
+        }
+        if (QFile::remove(entry.filePath())) {
+            m_currentSize -= entry.size();
+        }
+    }
+
+    qCDebug(KGeoTagLog) << "Evicted track cache entries, the cache now uses" << m_currentSize
+                        << "bytes";
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef TRACKCACHE_H
+#define TRACKCACHE_H
+
+// Local includes
+#include "GpxEngine.h"
+
+// Qt includes
+#include <QObject>
+#include <QMutex>
+
+// Local classes
+class Track;
+
+// Qt classes
+class QFileInfo;
+
+// Binary snapshots of read tracks, so that a GPX file doesn't have to be parsed again as long as it
+// isn't changed
+class TrackCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TrackCache(QObject *parent, int maximumSize);
+    bool isEnabled() const;
+
+    // Both functions are thread-safe. Along with the track, the significances of its points
+    // (cf. TrackLines::significances) are cached.
+    bool read(const QString &path, Track *track, QList<float> *significances,
+              GpxEngine::LoadInfo *info);
+    void store(const QString &path, const Track &track, const QList<float> &significances,
+               const GpxEngine::LoadInfo &info);
+
+private: // Functions
+    QString cacheFile(const QFileInfo &info) const;
+    void evict();
+
+private: // Variables
+    // In bytes. 0 disables the cache.
+    const qint64 m_maximumSize;
+
+    QString m_directory;
+
+    // read and store are called from the GPX file reading threads
+    QMutex m_mutex;
+    qint64 m_currentSize = -1;
+
+};
+
+#endif // TRACKCACHE_H
@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "TrackLines.h"
+#include "Track.h"
+
+// Marble includes
+#include <marble/GeoDataCoordinates.h>
+#include <marble/GeoDataLatLonBox.h>
+
+// Qt includes
+#include <QtMath>
+
+// C++ includes
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// The tolerance of the first simplified level (in degrees, about 5 m). Each following level
+// doubles it, until only the segments' first and last points are left.
+static const double s_finestTolerance = 0.00005;
+static const double s_toleranceFactor = 2.0;
+static const int s_maximumLevels = 24;
+
+// The maximum number of points of a segment's chunk
+static const int s_chunkSize = 1024;
+
+static const float s_alwaysKept = std::numeric_limits<float>::infinity();
+
+static double distance(double x, double y, double x1, double y1, double x2, double y2)
+{
+    // The distance of (x, y) from the line (x1, y1) - (x2, y2)
+
+    const double dx = x2 - x1;
+    const double dy = y2 - y1;
+    const double lengthSquared = dx * dx + dy * dy;
+
+    double position = lengthSquared > 0.0
+        ? ((x - x1) * dx + (y - y1) * dy) / lengthSquared : 0.0;
+    position = std::clamp(position, 0.0, 1.0);
+
+    return std::hypot(x - (x1 + position * dx), y - (y1 + position * dy));
+}
+
+static void calculateSignificances(const Track &track, int start, int end,
+                                   QList<float> *significances)
+{
+    // Calculates the largest tolerance for each point of a segment with which the Douglas-Peucker
+    // algorithm would still keep it. This way, the algorithm only has to run once for all levels.
+    // The significance of a point is never higher than the one of the point that caused its part
+    // of the segment to be split, so that each level contains all points of the coarser ones.
+
+    struct Range
+    {
+        int first;
+        int last;
+        double significance;
+    };
+
+    const int count = end - start;
+    if (count == 0) {
+        return;
+    }
+
+    (*significances)[start] = s_alwaysKept;
+    (*significances)[end - 1] = s_alwaysKept;
+
+    // Degrees of longitude get shorter towards the poles
+    const double lonScale = std::cos(qDegreesToRadians(
+        (track.lat(start) + track.lat(end - 1)) / 2.0));
+
+    const auto x = [&](int point)
+    {
+        return track.lon(start + point) * lonScale;
+    };
+    const auto y = [&](int point)
+    {
+        return track.lat(start + point);
+    };
+
+    // We use an explicit stack here, a segment can have way too many points for recursion
+    QList<Range> ranges { { 0, count - 1, s_alwaysKept } };
+    while (! ranges.isEmpty()) {
+        const auto range = ranges.takeLast();
+        if (range.last - range.first < 2) {
+            continue;
+        }
+
+        const double x1 = x(range.first);
+        const double y1 = y(range.first);
+        const double x2 = x(range.last);
+        const double y2 = y(range.last);
+
+        int farthestPoint = range.first + 1;
+        double farthestDistance = -1.0;
+        for (int point = range.first + 1; point < range.last; point++) {
+            const double pointDistance = distance(x(point), y(point), x1, y1, x2, y2);
+            if (pointDistance > farthestDistance) {
+                farthestPoint = point;
+                farthestDistance = pointDistance;
+            }
+        }
+
+        const double significance = std::min(farthestDistance, range.significance);
+        (*significances)[start + farthestPoint] = float(significance);
+        ranges.append({ range.first, farthestPoint, significance });
+        ranges.append({ farthestPoint, range.last, significance });
+    }
+}
+
+// The bounding box of some points, built up point by point
+class BoxBuilder
+{
+
+public:
+    void add(double lon, double lat)
+    {
+        m_north = std::max(m_north, lat);
+        m_south = std::min(m_south, lat);
+        m_east = std::max(m_east, lon);
+        m_west = std::min(m_west, lon);
+    }
+
+    Marble::GeoDataLatLonAltBox box() const
+    {
+        return Marble::GeoDataLatLonAltBox(Marble::GeoDataLatLonBox(
+            m_north, m_south, m_east, m_west, Marble::GeoDataCoordinates::Degree), 0.0, 0.0);
+    }
+
+private: // Variables
+    double m_north = -90.0;
+    double m_south = 90.0;
+    double m_east = -180.0;
+    double m_west = 180.0;
+
+};
+
+static TrackLines::Segment createSegment(const Track &track, int start, int end,
+                                         const QList<float> &significances, double tolerance)
+{
+    // Creates the chunks of a segment, containing all points at least as significant as the given
+    // tolerance. The chunks of the full resolution only store their range of points.
+
+    const bool simplified = tolerance > 0.0;
+
+    TrackLines::Segment segment;
+    BoxBuilder segmentBox;
+    TrackLines::Chunk chunk;
+    BoxBuilder chunkBox;
+    int chunkSize = 0;
+
+    const auto addPoint = [&](int point)
+    {
+        if (chunkSize == 0) {
+            chunk.first = point;
+        }
+        chunk.last = point;
+        if (simplified) {
+            chunk.points.append(point);
+        }
+        chunkSize++;
+
+        const double lon = track.lon(point);
+        const double lat = track.lat(point);
+        chunkBox.add(lon, lat);
+        segmentBox.add(lon, lat);
+    };
+
+    for (int point = start; point < end; point++) {
+        if (significances.at(point) < tolerance) {
+            continue;
+        }
+
+        if (chunkSize == s_chunkSize) {
+            const int lastPoint = chunk.last;
+            chunk.box = chunkBox.box();
+            segment.chunks.append(chunk);
+            chunk = TrackLines::Chunk();
+            chunkBox = BoxBuilder();
+            chunkSize = 0;
+            // Start the next chunk where the last one ended
+            addPoint(lastPoint);
+        }
+
+        addPoint(point);
+    }
+
+    if (chunkSize > 0) {
+        chunk.box = chunkBox.box();
+        segment.chunks.append(chunk);
+    }
+    segment.box = segmentBox.box();
+
+    return segment;
+}
+
+TrackLines::TrackLines()
+{
+}
+
+TrackLines::TrackLines(const Track &track)
+    : TrackLines(track, significances(track))
+{
+}
+
+TrackLines::TrackLines(const Track &track, const QList<float> &significances)
+    : m_track(track)
+{
+    // The first level is the full resolution, as all points have a significance of at least 0
+    int lastCount = -1;
+    double tolerance = 0.0;
+
+    for (int i = 0; i < s_maximumLevels; i++) {
+        int count = 0;
+        bool onlyEndpoints = true;
+        for (const float significance : significances) {
+            if (significance >= tolerance) {
+                count++;
+                onlyEndpoints = onlyEndpoints && significance == s_alwaysKept;
+            }
+        }
+
+        // A level with as many points as the previous one is of no use, the previous one will be
+        // chosen for this tolerance, too
+        if (count != lastCount) {
+            Level level { tolerance, {} };
+            for (int segment = 0; segment < track.segmentCount(); segment++) {
+                level.segments.append(createSegment(track, track.segmentStart(segment),
+                                                    track.segmentEnd(segment), significances,
+                                                    tolerance));
+            }
+            m_levels.append(level);
+            lastCount = count;
+        }
+
+        if (onlyEndpoints) {
+            break;
+        }
+
+        tolerance = i == 0 ? s_finestTolerance : tolerance * s_toleranceFactor;
+    }
+}
+
+QList<float> TrackLines::significances(const Track &track)
+{
+    QList<float> significances(track.count(), 0.0f);
+    for (int segment = 0; segment < track.segmentCount(); segment++) {
+        calculateSignificances(track, track.segmentStart(segment), track.segmentEnd(segment),
+                               &significances);
+    }
+    return significances;
+}
+
+int TrackLines::level(double tolerance) const
+{
+    for (int i = m_levels.count() - 1; i > 0; i--) {
+        if (m_levels.at(i).tolerance <= tolerance) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+const QList<TrackLines::Segment> &TrackLines::segments(int level) const
+{
+    return m_levels.at(level).segments;
+}
+
+const Marble::GeoDataLatLonAltBox &TrackLines::box() const
+{
+    return m_track.box();
+}
+
+const Track &TrackLines::track() const
+{
+    return m_track;
+}
+
+Marble::GeoDataLineString TrackLines::lineString(const Chunk &chunk) const
+{
+    Marble::GeoDataLineString lineString;
+    lineString.reserve(chunk.count());
+    for (int i = 0; i < chunk.count(); i++) {
+        const int point = chunk.point(i);
+        lineString.append(Marble::GeoDataCoordinates(m_track.lon(point), m_track.lat(point), 0.0,
+                                                     Marble::GeoDataCoordinates::Degree));
+    }
+    return lineString;
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef TRACKLINES_H
+#define TRACKLINES_H
+
+// Local includes
+#include "Track.h"
+
+// Marble includes
+#include <marble/GeoDataLineString.h>
+#include <marble/GeoDataLatLonAltBox.h>
+
+// Qt includes
+#include <QList>
+
+// The lines used to draw one track on the map. Besides the full resolution ones, they are kept in
+// several levels of detail, simplified using the Douglas-Peucker algorithm, so that a zoomed out
+// map doesn't have to draw more points than it can display.
+//
+// The lines don't copy the points, they only refer to them by their index in the (implicitly
+// shared) track. The full resolution level only stores the range of each chunk, each simplified
+// level 4 bytes per point it keeps. The coarser a level is, the less points it keeps, so all
+// levels together usually need a lot less memory than the track itself.
+class TrackLines
+{
+
+public:
+    // Each segment is split up into chunks of a limited number of points, so that only the parts
+    // of a long segment inside the visible area have to be drawn. Consecutive chunks share their
+    // boundary point, so that the line is not interrupted.
+    struct Chunk
+    {
+        // The chunk's points are all points of the track from first to last, or the ones listed
+        // in points if the level is simplified
+        int first = 0;
+        int last = -1;
+        QList<int> points;
+        Marble::GeoDataLatLonAltBox box;
+
+        int count() const
+        {
+            return points.isEmpty() ? last - first + 1 : int(points.count());
+        }
+
+        int point(int index) const
+        {
+            return points.isEmpty() ? first + index : points.at(index);
+        }
+    };
+
+    struct Segment
+    {
+        QList<Chunk> chunks;
+        Marble::GeoDataLatLonAltBox box;
+    };
+
+    explicit TrackLines();
+    explicit TrackLines(const Track &track);
+    // Uses the points' significances calculated before, which have to be the ones of the track
+    explicit TrackLines(const Track &track, const QList<float> &significances);
+
+    // The largest tolerance for each point of the track with which it's still kept when simplifying
+    // the track. Calculating this is the expensive part of creating the lines, so it's stored in
+    // the TrackCache along with the track.
+    static QList<float> significances(const Track &track);
+
+    // Returns the coarsest level that deviates from the track by no more than the given tolerance
+    // (in degrees). Level 0 is the full resolution.
+    int level(double tolerance) const;
+    const QList<Segment> &segments(int level) const;
+    const Marble::GeoDataLatLonAltBox &box() const;
+    const Track &track() const;
+    Marble::GeoDataLineString lineString(const Chunk &chunk) const;
+
+private: // Structs
+    struct Level
+    {
+        double tolerance;
+        QList<Segment> segments;
+    };
+
+private: // Variables
+    Track m_track;
+    QList<Level> m_levels;
+
+};
+
+#endif // TRACKLINES_H
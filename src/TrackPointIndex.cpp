@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+// Local includes
+#include "TrackPointIndex.h"
+
+// C++ includes
+#include <algorithm>
+#include <limits>
+
+TrackPointIndex::TrackPointIndex()
+{
+}
+
+void TrackPointIndex::clear()
+{
+    m_times.clear();
+    m_coordinates.clear();
+}
+
+int TrackPointIndex::count() const
+{
+    return m_times.count();
+}
+
+void TrackPointIndex::addTrack(const Track &track)
+{
+    // The track's points can be accessed sorted by time, so we can merge them with the points we
+    // already have in one go
+
+    QList<qint64> times;
+    QList<Coordinates> coordinates;
+    times.reserve(m_times.count() + track.count());
+    coordinates.reserve(m_times.count() + track.count());
+
+    int existing = 0;
+    bool lastAdded = false;
+
+    // Points without a (valid) timestamp can't be matched anyway
+    for (int i = track.firstTimedPoint(); i < track.count(); i++) {
+        const auto time = track.sortedTime(i);
+
+        // If the track contains multiple points for the same second, the last one is used
+        if (lastAdded && times.last() == time) {
+            coordinates.last() = track.sortedCoordinates(i);
+            continue;
+        }
+        lastAdded = false;
+
+        while (existing < m_times.count() && m_times.at(existing) < time) {
+            times.append(m_times.at(existing));
+            coordinates.append(m_coordinates.at(existing));
+            existing++;
+        }
+
+        // A previously loaded track already has a point for this second
+        if (existing < m_times.count() && m_times.at(existing) == time) {
+            continue;
+        }
+
+        times.append(time);
+        coordinates.append(track.sortedCoordinates(i));
+        lastAdded = true;
+    }
+
+    while (existing < m_times.count()) {
+        times.append(m_times.at(existing));
+        coordinates.append(m_coordinates.at(existing));
+        existing++;
+    }
+
+    m_times = times;
+    m_coordinates = coordinates;
+}
+
+Coordinates TrackPointIndex::findClosest(qint64 time, int tolerance) const
+{
+    // Find the first point not earlier than the requested time
+    const auto after = std::lower_bound(m_times.constBegin(), m_times.constEnd(), time);
+    return closestTo(after - m_times.constBegin(), time, tolerance);
+}
+
+QList<Coordinates> TrackPointIndex::findClosest(const QList<qint64> &sortedTimes,
+                                                int tolerance) const
+{
+    QList<Coordinates> coordinates;
+    coordinates.reserve(sortedTimes.count());
+
+    if (sortedTimes.isEmpty()) {
+        return coordinates;
+    }
+
+    // Find the first point not earlier than the first requested time. As the requested times are
+    // sorted as well, we can walk through both lists in parallel from there and never have to
+    // search backwards.
+    int after = std::lower_bound(m_times.constBegin(), m_times.constEnd(), sortedTimes.first())
+                - m_times.constBegin();
+    for (const auto time : sortedTimes) {
+        while (after < m_times.count() && m_times.at(after) < time) {
+            after++;
+        }
+        coordinates.append(closestTo(after, time, tolerance));
+    }
+
+    return coordinates;
+}
+
+Coordinates TrackPointIndex::closestTo(int afterIndex, qint64 time, int tolerance) const
+{
+    // afterIndex is the index of the first point not earlier than the requested time
+
+    const auto afterDistance = afterIndex < m_times.count()
+        ? m_times.at(afterIndex) - time : std::numeric_limits<qint64>::max();
+    const auto beforeDistance = afterIndex > 0
+        ? time - m_times.at(afterIndex - 1) : std::numeric_limits<qint64>::max();
+
+    // If both points are equally close, we prefer the earlier one
+    if (beforeDistance <= afterDistance && beforeDistance <= tolerance) {
+        return m_coordinates.at(afterIndex - 1);
+    }
+    if (afterDistance <= tolerance) {
+        return m_coordinates.at(afterIndex);
+    }
+
+    // No match found
+    return Coordinates();
+}
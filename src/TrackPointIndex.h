@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+//
+// SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef TRACKPOINTINDEX_H
+#define TRACKPOINTINDEX_H
+
+// Local includes
+#include "Coordinates.h"
+#include "Track.h"
+
+// Qt includes
+#include <QList>
+
+class TrackPointIndex
+{
+
+public:
+    explicit TrackPointIndex();
+    void clear();
+    void addTrack(const Track &track);
+    int count() const;
+    Coordinates findClosest(qint64 time, int tolerance) const;
+    QList<Coordinates> findClosest(const QList<qint64> &sortedTimes, int tolerance) const;
+
+private: // Functions
+    Coordinates closestTo(int afterIndex, qint64 time, int tolerance) const;
+
+private: // Variables
+    // All points of all tracks, sorted by their time (in seconds since the epoch).
+    // Each second is only present once: if multiple tracks have a point for the same second, the
+    // one from the track loaded first is used.
+    QList<qint64> m_times;
+    QList<Coordinates> m_coordinates;
+
+};
+
+#endif // TRACKPOINTINDEX_H
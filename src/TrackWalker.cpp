@@ -37,7 +37,7 @@ void TrackWalker::setToTrack(int row)
 {
     m_trackIndex = row;
 
-    const int count = row != -1 ? m_geoDataModel->dateTimes().at(row).count() : 1;
+    const int count = row != -1 ? m_geoDataModel->tracks().at(row).count() : 1;
     m_slider->blockSignals(true);
     m_slider->setValue(1);
     m_slider->setMaximum(count);
@@ -9,17 +9,72 @@
 
 // Marble includes
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
+#include <marble/GeoDataLatLonAltBox.h>
+
+// Qt includes
+#include <QtMath>
+#include <QPainter>
+#include <QPolygonF>
 
 // C++ includes
 #include <utility>
+#include <cmath>
+#include <algorithm>
 
 static QStringList s_renderPosition { QStringLiteral("SURFACE") };
 
+// The deviation from the full resolution track we accept when drawing a simplified one, in pixels
+static const double s_pixelTolerance = 0.5;
+
+// The size of the rendered tiles (in device independent pixels)
+static const int s_tileSize = 256;
+
+// The maximum memory used by the rendered tiles, in KiB
+static const int s_tilesCacheSize = 128 * 1024;
+
+// The maximum latitude that can be displayed using the Mercator projection
+static const double s_maximumMercatorLat = qDegreesToRadians(85.05112878);
+
+// The y coordinate of a latitude on Marble's flat world maps (in radians). North is up, so
+// Marble's screen coordinates are the negative of this.
+static double projectedY(double lat, Marble::Projection projection)
+{
+    if (projection == Marble::Mercator) {
+        return std::asinh(std::tan(std::clamp(lat, -s_maximumMercatorLat, s_maximumMercatorLat)));
+    }
+    return lat;
+}
+
+static double unprojectedLat(double y, Marble::Projection projection)
+{
+    if (projection == Marble::Mercator) {
+        return std::atan(std::sinh(y));
+    }
+    return y;
+}
+
+// Marble's flat projections display one radian as 2 / π times the radius
+static double pixelsPerRadian(int radius)
+{
+    return 2.0 * radius / M_PI;
+}
+
+static int floorDivide(double value, int divisor)
+{
+    return int(std::floor(value / divisor));
+}
+
 TracksLayer::TracksLayer(QObject *parent, GeoDataModel *geoDataModel, QPen *trackPen)
     : QObject(parent),
       m_geoDataModel(geoDataModel),
       m_trackPen(trackPen)
 {
+    m_tiles.setMaxCost(s_tilesCacheSize);
+
+    // Tracks are added by changing the model's data
+    connect(m_geoDataModel, &QAbstractItemModel::dataChanged, this, &TracksLayer::clearCache);
+    connect(m_geoDataModel, &QAbstractItemModel::rowsRemoved, this, &TracksLayer::clearCache);
 }
 
 QStringList TracksLayer::renderPosition() const
@@ -27,16 +82,228 @@ QStringList TracksLayer::renderPosition() const
     return s_renderPosition;
 }
 
-bool TracksLayer::render(Marble::GeoPainter *painter, Marble::ViewportParams *, const QString &,
-                         Marble::GeoSceneLayer *)
+void TracksLayer::clearCache()
+{
+    m_tiles.clear();
+}
+
+bool TracksLayer::render(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
+                         const QString &, Marble::GeoSceneLayer *)
+{
+    // On the flat maps, panning only moves the world map, so we can render the tracks once and
+    // reuse the result until the zoom level changes
+    const auto projection = viewport->projection();
+    if (projection == Marble::Mercator || projection == Marble::Equirectangular) {
+        renderTiles(painter, viewport);
+    } else {
+        renderLines(painter, viewport);
+    }
+
+    return true;
+}
+
+void TracksLayer::renderLines(Marble::GeoPainter *painter, Marble::ViewportParams *viewport) const
 {
     painter->setPen(*m_trackPen);
 
-    for (const auto &segments : m_geoDataModel->marbleTracks()) {
-        for (const auto &segment : segments) {
-            painter->drawPolyline(segment);
+    // Choose the simplified tracks so that the omitted points wouldn't be visible anyway. The
+    // whole world (360°) is 2π times the radius wide.
+    const double tolerance = s_pixelTolerance * 360.0 / (2.0 * M_PI * viewport->radius());
+    const auto &viewportBox = viewport->viewLatLonAltBox();
+
+    // Only draw the parts of the tracks inside the visible area. This way, the drawing cost
+    // depends on what's actually displayed, not on the number of loaded tracks and points.
+    for (const auto &trackLines : m_geoDataModel->trackLines()) {
+        if (! viewportBox.intersects(trackLines.box())) {
+            continue;
+        }
+
+        for (const auto &segment : trackLines.segments(trackLines.level(tolerance))) {
+            if (! viewportBox.intersects(segment.box)) {
+                continue;
+            }
+
+            for (const auto &chunk : segment.chunks) {
+                if (viewportBox.intersects(chunk.box)) {
+                    painter->drawPolyline(trackLines.lineString(chunk));
+                }
+            }
         }
     }
+}
 
-    return true;
+void TracksLayer::renderTiles(Marble::GeoPainter *painter, Marble::ViewportParams *viewport)
+{
+    const auto projection = viewport->projection();
+    const int radius = viewport->radius();
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+
+    if (projection != m_tilesProjection || radius != m_tilesRadius
+        || devicePixelRatio != m_tilesDevicePixelRatio) {
+
+        m_tiles.clear();
+        m_tilesProjection = projection;
+        m_tilesRadius = radius;
+        m_tilesDevicePixelRatio = devicePixelRatio;
+    }
+
+    // The tiles are positioned relative to the point at 0° longitude and 0° latitude. The world
+    // map is 4 times the radius wide and repeated horizontally.
+
+    qreal originX;
+    qreal originY;
+    viewport->screenCoordinates(0.0, 0.0, originX, originY);
+    const int x = qRound(originX);
+    const int y = qRound(originY);
+
+    const int worldWidth = 4 * radius;
+    const int worldHeight = qRound(projectedY(M_PI / 2.0, projection) * pixelsPerRadian(radius));
+
+    const int top = std::max(-y, -worldHeight);
+    const int bottom = std::min(viewport->height() - y, worldHeight);
+    if (top >= bottom) {
+        return;
+    }
+    const int firstRow = floorDivide(top, s_tileSize);
+    const int lastRow = floorDivide(bottom - 1, s_tileSize);
+
+    const int left = -x;
+    const int right = viewport->width() - x;
+    const int firstCopy = floorDivide(left + worldWidth / 2, worldWidth);
+    const int lastCopy = floorDivide(right - 1 + worldWidth / 2, worldWidth);
+
+    // GeoPainter hides QPainter's functions using screen coordinates
+    QPainter *screenPainter = painter;
+
+    for (int copy = firstCopy; copy <= lastCopy; copy++) {
+        const int offset = copy * worldWidth;
+        const int firstColumn = floorDivide(std::max(left - offset, -worldWidth / 2), s_tileSize);
+        const int lastColumn = floorDivide(std::min(right - offset, worldWidth / 2) - 1,
+                                           s_tileSize);
+
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                const auto key = (quint64(quint32(column)) << 32) | quint32(row);
+                QImage tile;
+                if (const auto *cachedTile = m_tiles.object(key)) {
+                    tile = *cachedTile;
+                } else {
+                    tile = renderTile(column, row);
+                    m_tiles.insert(key, new QImage(tile),
+                                   std::max(qsizetype(1), tile.sizeInBytes() / 1024));
+                }
+
+                // Tiles without any tracks are null
+                if (! tile.isNull()) {
+                    screenPainter->drawImage(QPoint(x + offset + column * s_tileSize,
+                                                    y + row * s_tileSize), tile);
+                }
+            }
+        }
+    }
+}
+
+QImage TracksLayer::renderTile(int column, int row) const
+{
+    const double scale = pixelsPerRadian(m_tilesRadius);
+    const QRectF rect(column * s_tileSize, row * s_tileSize, s_tileSize, s_tileSize);
+
+    // Also include the lines passing by closely, as they are drawn with the pen's width
+    const double margin = m_trackPen->widthF() / 2.0 + 1.0;
+    const auto area = rect.adjusted(-margin, -margin, margin, margin);
+
+    const double west = std::max(area.left() / scale, -M_PI);
+    const double east = std::min(area.right() / scale, M_PI);
+    const double north = std::min(unprojectedLat(-area.top() / scale, m_tilesProjection),
+                                  M_PI / 2.0);
+    const double south = std::max(unprojectedLat(-area.bottom() / scale, m_tilesProjection),
+                                  -M_PI / 2.0);
+    if (west >= east || south >= north) {
+        return QImage();
+    }
+
+    const Marble::GeoDataLatLonAltBox tileBox(Marble::GeoDataLatLonBox(
+        north, south, east, west, Marble::GeoDataCoordinates::Radian), 0.0, 0.0);
+
+    // A pixel covers the least distance where the tile is nearest to a pole
+    const double tolerance = qRadiansToDegrees(
+        s_pixelTolerance * std::cos(std::max(std::abs(north), std::abs(south))) / scale);
+
+    // The image is only created if there's something to draw
+    QImage image;
+    QPainter tilePainter;
+
+    for (const auto &trackLines : m_geoDataModel->trackLines()) {
+        if (! tileBox.intersects(trackLines.box())) {
+            continue;
+        }
+
+        for (const auto &segment : trackLines.segments(trackLines.level(tolerance))) {
+            if (! tileBox.intersects(segment.box)) {
+                continue;
+            }
+
+            for (const auto &chunk : segment.chunks) {
+                if (! tileBox.intersects(chunk.box)) {
+                    continue;
+                }
+
+                if (image.isNull()) {
+                    image = QImage(QSize(s_tileSize, s_tileSize) * m_tilesDevicePixelRatio,
+                                   QImage::Format_ARGB32_Premultiplied);
+                    image.setDevicePixelRatio(m_tilesDevicePixelRatio);
+                    image.fill(Qt::transparent);
+                    tilePainter.begin(&image);
+                    tilePainter.setRenderHint(QPainter::Antialiasing);
+                    tilePainter.setPen(*m_trackPen);
+                    tilePainter.translate(-rect.topLeft());
+                }
+
+                // Where the track crosses the date line, the longitude jumps by almost 2π.
+                // Instead of connecting these points across the whole map, the line is
+                // continued into the neighbouring world copy. So we unwrap the longitudes and
+                // draw the line once more for each world copy it reaches into.
+
+                const auto &track = trackLines.track();
+                QPolygonF polyline;
+                polyline.reserve(chunk.count());
+                double offset = 0.0;
+                double lastLon = 0.0;
+                double minimumLon = M_PI;
+                double maximumLon = -M_PI;
+
+                for (int i = 0; i < chunk.count(); i++) {
+                    const int point = chunk.point(i);
+                    double lon = qDegreesToRadians(track.lon(point)) + offset;
+                    if (i > 0 && lon - lastLon > M_PI) {
+                        offset -= 2.0 * M_PI;
+                        lon -= 2.0 * M_PI;
+                    } else if (i > 0 && lon - lastLon < -M_PI) {
+                        offset += 2.0 * M_PI;
+                        lon += 2.0 * M_PI;
+                    }
+                    lastLon = lon;
+                    minimumLon = std::min(minimumLon, lon);
+                    maximumLon = std::max(maximumLon, lon);
+
+                    const double lat = qDegreesToRadians(track.lat(point));
+                    polyline.append(QPointF(lon * scale,
+                                            -projectedY(lat, m_tilesProjection) * scale));
+                }
+
+                const int firstCopy = int(std::ceil((minimumLon - M_PI) / (2.0 * M_PI)));
+                const int lastCopy = int(std::floor((maximumLon + M_PI) / (2.0 * M_PI)));
+                for (int copy = firstCopy; copy <= lastCopy; copy++) {
+                    tilePainter.drawPolyline(copy == 0
+                        ? polyline : polyline.translated(-copy * 2.0 * M_PI * scale, 0.0));
+                }
+            }
+        }
+    }
+
+    if (tilePainter.isActive()) {
+        tilePainter.end();
+    }
+
+    return image;
 }
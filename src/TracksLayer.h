@@ -8,9 +8,12 @@
 // Marble includes
 #include <marble/LayerInterface.h>
 #include <marble/GeoDataLineString.h>
+#include <marble/MarbleGlobal.h>
 
 // Qt includes
 #include <QObject>
+#include <QCache>
+#include <QImage>
 
 // Local classes
 class GeoDataModel;
@@ -33,13 +36,27 @@ class TracksLayer : public QObject, public Marble::LayerInterface
 public:
     TracksLayer(QObject *parent, GeoDataModel *geoDataModel, QPen *trackPen);
     QStringList renderPosition() const override;
-    bool render(Marble::GeoPainter *painter, Marble::ViewportParams *,
+    bool render(Marble::GeoPainter *painter, Marble::ViewportParams *viewport,
                 const QString &, Marble::GeoSceneLayer *) override;
+    void clearCache();
+
+private: // Functions
+    void renderLines(Marble::GeoPainter *painter, Marble::ViewportParams *viewport) const;
+    void renderTiles(Marble::GeoPainter *painter, Marble::ViewportParams *viewport);
+    QImage renderTile(int column, int row) const;
 
 private: // Variables
     GeoDataModel *m_geoDataModel;
     const QPen *m_trackPen;
 
+    // The tracks rendered to tiles of the flat world map, for the current zoom level. The key is
+    // the tile's column and row.
+    QCache<quint64, QImage> m_tiles;
+    // The parameters the cached tiles have been rendered with
+    Marble::Projection m_tilesProjection = Marble::Mercator;
+    int m_tilesRadius = 0;
+    qreal m_tilesDevicePixelRatio = 0.0;
+
 };
 
 #endif // TRACKSLAYER_H
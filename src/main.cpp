@@ -11,6 +11,7 @@
 #include <KCrash>
 #include <KLocalizedString>
 #include <KAboutData>
+#include <KExiv2/KExiv2>
 
 // Qt includes
 #include <QApplication>
@@ -53,6 +54,9 @@ int main(int argc, char *argv[])
     aboutData.processCommandLine(&commandLineParser);
     auto pathsToLoad = commandLineParser.positionalArguments();
 
+    // Images are loaded in multiple threads, so Exiv2 has to be initialized beforehand
+    KExiv2Iface::KExiv2::initializeExiv2();
+
     // Setup all shared objects
     SharedObjects sharedObjects;
 
@@ -66,5 +70,9 @@ int main(int argc, char *argv[])
     }
 
     // Run the QApplication
-    return application.exec();
+    const auto result = application.exec();
+
+    KExiv2Iface::KExiv2::cleanupExiv2();
+
+    return result;
 }
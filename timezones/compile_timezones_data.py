@@ -16,6 +16,9 @@
 
     The image height, output dir and shapefile input can be adjusted, cf. the --help message.
 
+    The "timezones.dat" lookup data file KGeoTag actually uses is created from both files by
+    compile_timezones_lookup.py when KGeoTag is built.
+
     This script requires QGIS to be installed on the machine, and is currently only tested on Linux.
     However, with a few tweaks, it could most probably work on Windows as well.
 """
@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+
+# SPDX-FileCopyrightText: 2026 Tobias Leupold <tl@stonemx.de>
+#
+# SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+"""
+    This script takes the "timezones.png" and "timezones.json" files generated by
+    compile_timezones_data.py and turns them into "timezones.dat", the compact lookup data file
+    KGeoTag actually uses. It's run by the build system, but can also be run on its own.
+
+    Each row of the timezones map is stored run-length encoded, as a list of (end column, timezone
+    index) pairs. Pixels with a color not listed in the mapping get the index 0xFFFF.
+
+    All numbers are little endian. The file layout is:
+
+        "KGTZ" magic
+        uint32 version
+        uint32 width, height
+        uint32 timezones count
+        for each timezone: uint8 length, the (ASCII) ID
+        uint32 row offsets (height + 1 values, indices of each row's first run)
+        uint16 pairs for all runs
+
+    This script only uses the Python standard library, so that no QGIS installation is needed.
+"""
+
+import argparse
+import json
+import struct
+import zlib
+from pathlib import Path
+
+MAGIC = b"KGTZ"
+VERSION = 1
+NO_TIMEZONE = 0xFFFF
+
+def paeth(a: int, b: int, c: int) -> int:
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+def read_png(png_file: Path) -> [int, int, list]:
+    """Decodes a non-interlaced 8 bit RGB or RGBA PNG file
+
+    Args:
+        png_file (Path): The file to read
+
+    Returns:
+        [int, int, list]: The width, the height and a list with the 0xRRGGBB colors of each row
+    """
+
+    data = png_file.read_bytes()
+    if data[0:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError(f"{png_file} is not a PNG file")
+
+    position = 8
+    compressed = bytearray()
+    while position < len(data):
+        length, chunk_type = struct.unpack(">I4s", data[position:position + 8])
+        chunk = data[position + 8:position + 8 + length]
+        position += length + 12
+
+        if chunk_type == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+            if depth != 8 or color_type not in (2, 6) or interlace != 0:
+                raise ValueError(f"{png_file} has an unsupported PNG format")
+            pixel_size = 4 if color_type == 6 else 3
+        elif chunk_type == b"IDAT":
+            compressed += chunk
+        elif chunk_type == b"IEND":
+            break
+
+    raw = zlib.decompress(bytes(compressed))
+    stride = width * pixel_size
+
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        filter_type = raw[start]
+        row = bytearray(raw[start + 1:start + 1 + stride])
+
+        if filter_type == 1:
+            for i in range(pixel_size, stride):
+                row[i] = (row[i] + row[i - pixel_size]) & 0xFF
+        elif filter_type == 2:
+            row = bytearray((a + b) & 0xFF for a, b in zip(row, previous))
+        elif filter_type == 3:
+            for i in range(stride):
+                left = row[i - pixel_size] if i >= pixel_size else 0
+                row[i] = (row[i] + ((left + previous[i]) >> 1)) & 0xFF
+        elif filter_type == 4:
+            for i in range(stride):
+                if i >= pixel_size:
+                    left = row[i - pixel_size]
+                    upper_left = previous[i - pixel_size]
+                else:
+                    left = 0
+                    upper_left = 0
+                row[i] = (row[i] + paeth(left, previous[i], upper_left)) & 0xFF
+
+        rows.append([(row[i] << 16) | (row[i + 1] << 8) | row[i + 2]
+                     for i in range(0, stride, pixel_size)])
+        previous = row
+
+    return width, height, rows
+
+def compile_lookup(path: Path, dat_file: Path) -> None:
+    """Creates timezones.dat from timezones.png and timezones.json
+
+    Args:
+        path (Path): The folder containing the input files
+        dat_file (Path): The output file
+    """
+
+    json_file = (path / "timezones.json").resolve()
+    print(f"Reading mappings JSON file from: {json_file.absolute()}")
+    with open(json_file) as f:
+        mapping = json.load(f)
+
+    timezone_ids = list(mapping.values())
+    color_index = {}
+    for i, color in enumerate(mapping.keys()):
+        color_index[int(color[1:], 16)] = i
+
+    png_file = (path / "timezones.png").resolve()
+    print(f"Reading PNG map from: {png_file.absolute()}")
+    width, height, rows = read_png(png_file)
+
+    print("Encoding the map")
+    row_offsets = [0]
+    runs = []
+    for row in rows:
+        x = 0
+        while x < width:
+            color = row[x]
+            end = x + 1
+            while end < width and row[end] == color:
+                end += 1
+            runs.append((end, color_index.get(color, NO_TIMEZONE)))
+            x = end
+        row_offsets.append(len(runs))
+
+    data = bytearray()
+    data += MAGIC
+    data += struct.pack("<IIII", VERSION, width, height, len(timezone_ids))
+    for timezone_id in timezone_ids:
+        encoded = timezone_id.encode("ascii")
+        data += struct.pack("<B", len(encoded)) + encoded
+    data += struct.pack(f"<{len(row_offsets)}I", *row_offsets)
+    for end, index in runs:
+        data += struct.pack("<HH", end, index)
+
+    dat_file = dat_file.resolve()
+    print(f"Saving lookup data to: {dat_file.absolute()} ({len(runs)} runs, {len(data)} bytes)")
+    dat_file.write_bytes(data)
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--dir",
+                        type = Path,
+                        help = "The folder containing timezones.png and timezones.json "
+                               "(defaults to .)",
+                        default = ".")
+    parser.add_argument("--output",
+                        type = Path,
+                        help = "The lookup data file to create (defaults to timezones.dat in the "
+                               "folder given by --dir)")
+    args = vars(parser.parse_args())
+    output = args["output"] if args["output"] is not None else args["dir"] / "timezones.dat"
+    compile_lookup(args["dir"], output)
+
+if __name__ == "__main__":
+    main()